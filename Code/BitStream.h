@@ -0,0 +1,102 @@
+#pragma once
+#include <Arduino.h>
+
+// Побитовая запись/чтение в фиксированный буфер (для сжатых блоков журнала).
+// Целые со знаком кодируются zigzag + префиксом длины:
+//   0          - ноль
+//   10  + 6 бит
+//   110 + 12 бит
+//   111 + 32 бита
+class BitWriter {
+public:
+  BitWriter(uint8_t* buffer, uint16_t capacity) : buffer(buffer), capacity(capacity) {
+    reset();
+  }
+
+  void reset() {
+    bitPos = 0;
+    memset(buffer, 0, capacity);
+  }
+
+  void write(uint32_t value, uint8_t bits) {
+    for(int8_t i = bits - 1; i >= 0; i--) {
+      if(bitPos >= (uint32_t)capacity * 8) return;
+      if((value >> i) & 1) {
+        buffer[bitPos / 8] |= 0x80 >> (bitPos % 8);
+      }
+      bitPos++;
+    }
+  }
+
+  void writeSigned(int32_t value) {
+    uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    if(zigzag == 0) {
+      write(0, 1);
+    } else if(zigzag < (1u << 6)) {
+      write(0b10, 2);
+      write(zigzag, 6);
+    } else if(zigzag < (1u << 12)) {
+      write(0b110, 3);
+      write(zigzag, 12);
+    } else {
+      write(0b111, 3);
+      write(zigzag, 32);
+    }
+  }
+
+  uint16_t bytesUsed() const {
+    return (bitPos + 7) / 8;
+  }
+
+  uint16_t bitsFree() const {
+    return capacity * 8 - bitPos;
+  }
+
+private:
+  uint8_t* buffer;
+  uint16_t capacity;
+  uint32_t bitPos = 0;
+};
+
+class BitReader {
+public:
+  BitReader(const uint8_t* buffer, uint16_t length) : buffer(buffer), length(length) {}
+
+  uint32_t read(uint8_t bits) {
+    uint32_t value = 0;
+    for(uint8_t i = 0; i < bits; i++) {
+      value <<= 1;
+      if(bitPos < (uint32_t)length * 8) {
+        value |= (buffer[bitPos / 8] >> (7 - bitPos % 8)) & 1;
+      } else {
+        overrun = true;
+      }
+      bitPos++;
+    }
+    return value;
+  }
+
+  int32_t readSigned() {
+    uint32_t zigzag;
+    if(read(1) == 0) {
+      return 0;
+    } else if(read(1) == 0) {
+      zigzag = read(6);
+    } else if(read(1) == 0) {
+      zigzag = read(12);
+    } else {
+      zigzag = read(32);
+    }
+    return (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+  }
+
+  bool isOverrun() const {
+    return overrun;
+  }
+
+private:
+  const uint8_t* buffer;
+  uint16_t length;
+  uint32_t bitPos = 0;
+  bool overrun = false;
+};
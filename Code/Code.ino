@@ -6,6 +6,11 @@
 #include "TemperatureControl.h"
 #include "WiFiManager.h"
 #include "EncoderHandler.h"
+#include "TaskScheduler.h"
+#include "SharedState.h"
+#include "TelemetryHistory.h"
+#include "TelemetryLog.h"
+#include "I2CBus.h"
 
 // Создаем все объекты
 RTCTimeManager timeManager;
@@ -13,31 +18,285 @@ RelayController relay;
 ScheduleManager scheduler(relay);
 DisplayManager display(relay, scheduler, timeManager);
 TemperatureControl tempControl(relay);
-WiFiManager wifi(timeManager, scheduler);
+SharedState sharedState;
+TelemetryHistory history;
+TelemetryLog telemetryLog(history);
+WiFiManager wifi(timeManager, scheduler, tempControl, sharedState, history, telemetryLog);
 EncoderHandler encoder;
-MenuSystem menu(display, encoder, timeManager, scheduler, wifi, tempControl);
+MenuSystem menu(display, encoder, timeManager, scheduler, wifi, tempControl, sharedState, relay);
+
+// Каждая задача FreeRTOS крутит свой кооперативный планировщик
+TaskScheduler controlTasks;
+TaskScheduler networkTasks;
+TaskScheduler uiTasks;
+
+uint8_t menuTaskId = TaskScheduler::INVALID_TASK;
+uint8_t tm1637StepTaskId = TaskScheduler::INVALID_TASK;
+uint8_t scheduleTaskId = TaskScheduler::INVALID_TASK;
+uint8_t temperatureTaskId = TaskScheduler::INVALID_TASK;
+uint8_t rtcSyncTaskId = TaskScheduler::INVALID_TASK;
+uint8_t webTaskId = TaskScheduler::INVALID_TASK;
+TaskHandle_t webEventsTask = nullptr;
+
+// ---- Контур управления: температура, реле, расписание ----
+void publishSnapshot() {
+  ControlSnapshot snapshot;
+  snapshot.temperature = tempControl.getTemperature();
+  snapshot.rawTemperature = tempControl.getRawTemperature();
+  snapshot.overheated = tempControl.isOverheated();
+  snapshot.slope = tempControl.getSlope();
+  snapshot.predictedMs = tempControl.getPredictedCrossing();
+  snapshot.updatedAt = tempControl.getSampleTime();
+  snapshot.sensorCount = tempControl.getSensorCount();
+  snapshot.hottestSensor = tempControl.getHottestSensor();
+  for (uint8_t i = 0; i < snapshot.sensorCount; i++) {
+    const TemperatureControl::Sensor& sensor = tempControl.getSensor(i);
+    snapshot.sensors[i].temperature = sensor.temperature;
+    snapshot.sensors[i].rawTemperature = sensor.raw;
+    snapshot.sensors[i].slope = sensor.riseRate;
+    snapshot.sensors[i].failed = sensor.failed;
+    snapshot.sensors[i].highThreshold = sensor.highThreshold;
+    snapshot.sensors[i].lowThreshold = sensor.lowThreshold;
+    snapshot.sensors[i].protects = sensor.protects;
+  }
+  sharedState.publish(snapshot);
+}
+
+void temperatureTask() {
+  bool wasBlocked = relay.isBlocked();
+  // Конвертация DS18B20 идет в фоне: задача просыпается к ее окончанию
+  controlTasks.scheduleIn(temperatureTaskId, tempControl.update());
+  publishSnapshot();
+  if (wasBlocked && !relay.isBlocked()) {
+    controlTasks.trigger(scheduleTaskId); // Блокировка снята - вернуть реле к расписанию
+  }
+}
+
+// Раз в секунду: выборка в историю (старшие ярусы собираются внутри)
+void historyTask() {
+  uint8_t flags = 0;
+  if (relay.getState()) flags |= TelemetryHistory::FLAG_RELAY_ON;
+  if (relay.isBlocked()) flags |= TelemetryHistory::FLAG_BLOCKED;
+  if (tempControl.isOverheated()) flags |= TelemetryHistory::FLAG_OVERHEAT;
+  history.record(timeManager.nowEpoch(), tempControl.getTemperature(), flags);
+}
+
+// Замер фронта секунды DS3231 идет короткими шагами - задача сама назначает следующий
+void rtcResyncTask() {
+  controlTasks.scheduleIn(rtcSyncTaskId, timeManager.resync());
+}
+
+// Расписание переключается только по событиям: таймер фронта,
+// изменение расписания, скачок часов или снятие блокировки
+void wakeScheduleTask() {
+  controlTasks.triggerAsync(scheduleTaskId);
+}
+
+void wakeTemperatureTask() {
+  controlTasks.triggerAsync(temperatureTaskId);
+}
+
+void scheduleTask() {
+  scheduler.update(timeManager.nowEpochUs());
+}
+
+void scheduleAuditTask() {
+  scheduler.audit(timeManager.nowEpochUs());
+}
+
+// ---- Сеть: WiFi, веб-сервер, NTP ----
+// Запускается только по событиям сокетов (или по таймауту ожидания)
+void webTask() {
+  wifi.handleClient();
+  if(webEventsTask) xTaskNotifyGive(webEventsTask);
+}
+
+// Ждет событий веб-сервера и будит сетевую задачу. Следующее ожидание -
+// только после handleClient(): сокеты не меняются во время select()
+void webEventsMain(void* param) {
+  for (;;) {
+    wifi.waitForEvents(WEB_EVENT_TIMEOUT);
+    networkTasks.triggerAsync(webTaskId);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
+
+void ntpTask() {
+  timeManager.pollSync();
+}
+
+// Закрытые минуты истории -> сжатые блоки во флеше
+void logTask() {
+  telemetryLog.update();
+}
+
+void statsTask() {
+  Serial.println("[control]");
+  controlTasks.printStats(Serial);
+  Serial.println("[network]");
+  networkTasks.printStats(Serial);
+  Serial.println("[ui]");
+  uiTasks.printStats(Serial);
+
+  const EncoderHandler::LatencyStats& latency = encoder.getLatencyStats();
+  Serial.printf("input->screen: samples=%u avg_us=%u max_us=%u dropped=%u\n",
+                (unsigned)latency.samples,
+                (unsigned)(latency.samples ? latency.totalUs / latency.samples : 0),
+                (unsigned)latency.maxUs, (unsigned)encoder.getDroppedEvents());
+  const MenuSystem::RenderStats& render = menu.getRenderStats();
+  const PartialSSD1306::FlushStats& flush = display.getFlushStats();
+  // Без счета выделений - только прирост блоков кучи, см. HeapMonitor.h
+  Serial.printf("oled: frames=%u redraws=%u %s=%u %s=%u submits=%u flushes=%u deferred=%u windows=%u i2c_bytes=%u max_flush_us=%u\n",
+                (unsigned)render.frames, (unsigned)render.redraws,
+                HeapMonitor::COUNTS_ALLOCATIONS ? "heap_allocs" : "heap_net_blocks", (unsigned)render.heapCount,
+                HeapMonitor::COUNTS_ALLOCATIONS ? "alloc_frames" : "net_block_frames", (unsigned)render.heapFrames,
+                (unsigned)display.getFlushCount(), (unsigned)flush.flushes,
+                (unsigned)flush.deferred, (unsigned)flush.windows,
+                (unsigned)flush.bytes, (unsigned)flush.maxFlushUs);
+  const SegmentDisplay::Stats& segments = display.getTM1637Stats();
+  Serial.printf("tm1637: requests=%u frames=%u bytes=%u nacks=%u\n",
+                (unsigned)segments.requests, (unsigned)segments.frames,
+                (unsigned)segments.bytes, (unsigned)segments.nacks);
+  const I2CBus::DeviceStats& rtcBus = I2CBus::getStats(I2CBus::DEVICE_RTC);
+  const I2CBus::DeviceStats& oledBus = I2CBus::getStats(I2CBus::DEVICE_OLED);
+  Serial.printf("i2c: clock=%u rtc_tx=%u rtc_busy_us=%llu rtc_max_hold_us=%u rtc_waits=%u rtc_max_wait_us=%u "
+                "oled_tx=%u oled_busy_us=%llu oled_max_hold_us=%u oled_waits=%u oled_max_wait_us=%u\n",
+                (unsigned)I2C_BUS_CLOCK,
+                (unsigned)rtcBus.transactions, (unsigned long long)rtcBus.busyUs,
+                (unsigned)rtcBus.maxHoldUs, (unsigned)rtcBus.waits, (unsigned)rtcBus.maxWaitUs,
+                (unsigned)oledBus.transactions, (unsigned long long)oledBus.busyUs,
+                (unsigned)oledBus.maxHoldUs, (unsigned)oledBus.waits, (unsigned)oledBus.maxWaitUs);
+  const HttpServer::Stats& web = wifi.getWebStats();
+  Serial.printf("web: accepted=%u requests=%u keepalive_reused=%u timeouts=%u errors=%u max_handler_us=%u\n",
+                (unsigned)web.accepted, (unsigned)web.requests, (unsigned)web.reused,
+                (unsigned)web.timeouts, (unsigned)web.errors, (unsigned)web.maxHandlerUs);
+  Serial.printf("rtc: resyncs=%u corrections=%u last_drift_ms=%d total_drift_ms=%u\n",
+                (unsigned)timeManager.getResyncCount(), (unsigned)timeManager.getDriftCorrections(),
+                (int)timeManager.getLastDrift(), (unsigned)timeManager.getTotalDrift());
+  Serial.printf("ntp: offset_us=%lld rtt_us=%u age_s=%u failures=%u server=%s\n",
+                (long long)timeManager.getLastNtpOffsetUs(), (unsigned)timeManager.getLastNtpRttUs(),
+                (unsigned)timeManager.getSyncAge(), (unsigned)timeManager.getSyncFailures(),
+                timeManager.getLastNtpServer());
+  Serial.printf("ds18b20: sensors=%u conversions=%u errors=%u resets=%u mode_switches=%u predictive_trips=%u age_ms=%lu\n",
+                (unsigned)tempControl.getSensorCount(), (unsigned)tempControl.getConversionCount(),
+                (unsigned)tempControl.getReadErrors(), (unsigned)tempControl.getSensorResets(),
+                (unsigned)tempControl.getModeSwitches(),
+                (unsigned)tempControl.getPredictiveTrips(), tempControl.getSampleAge());
+  const ScheduleManager::EdgeStats& edges = scheduler.getEdgeStats();
+  Serial.printf("edges: fired=%u late=%u missed=%u max_late_us=%u\n",
+                (unsigned)edges.fired, (unsigned)edges.late,
+                (unsigned)edges.missed, (unsigned)edges.maxLatenessUs);
+  const TelemetryLog::Stats& logStats = telemetryLog.getStats();
+  Serial.printf("log: segments=%u bytes=%u blocks=%u compactions=%u deletions=%u errors=%u max_write_us=%u\n",
+                (unsigned)telemetryLog.getSegmentCount(), (unsigned)telemetryLog.getBytesUsed(),
+                (unsigned)logStats.blocksWritten, (unsigned)logStats.compactions,
+                (unsigned)logStats.deletions, (unsigned)logStats.writeErrors,
+                (unsigned)logStats.maxWriteUs);
+}
+
+// ---- UI: энкодер, меню, OLED, TM1637 ----
+// Прерывание энкодера будит задачу UI и сразу запускает меню
+void IRAM_ATTR onEncoderInput() {
+  uiTasks.triggerFromISR(menuTaskId);
+}
+
+// То же для кнопки, перечитанной таймером после окна дребезга
+void onEncoderDeferredInput() {
+  uiTasks.triggerAsync(menuTaskId);
+}
+
+void menuTask() {
+  menu.update();
+}
+
+// Отложенный кадр OLED можно отправлять - будим меню
+void onDisplayFlushed() {
+  uiTasks.triggerAsync(menuTaskId);
+}
+
+void oledFlushMain(void* param) {
+  display.runFlushLoop();
+}
+
+void tm1637Task() {
+  display.updateTM1637(timeManager.getNow(), sharedState.read().temperature);
+  if(display.isTM1637Pending()) {
+    uiTasks.trigger(tm1637StepTaskId);
+  }
+}
+
+// Передача на TM1637 по частям, пока кадр не уйдет целиком
+void tm1637StepTask() {
+  if(display.stepTM1637()) {
+    uiTasks.scheduleIn(tm1637StepTaskId, TM1637_STEP_INTERVAL);
+  }
+}
+
+void runScheduler(void* param) {
+  TaskScheduler* tasks = static_cast<TaskScheduler*>(param);
+  tasks->attachToCurrentTask();
+  for (;;) {
+    tasks->run();
+    tasks->sleepUntilNextDeadline();
+  }
+}
+
+void networkMain(void* param) {
+  // Подключение может занимать до 30 с - блокирует только сетевую задачу
+  wifi.init();
+  xTaskCreatePinnedToCore(webEventsMain, "web_events", WEB_EVENTS_TASK_STACK, nullptr,
+                          NETWORK_TASK_PRIORITY, &webEventsTask, PRO_CPU_NUM);
+  runScheduler(param);
+}
 
 // Инициализация периферии и загрузка сохраненных настроек
 void setup() {
 	Serial.begin(115200);
+	I2CBus::begin(); // До первого обращения DS3231 и OLED к шине
 	timeManager.init();
-  timeManager.syncTime();
 	relay = RelayController();
 	tempControl.init();
+	tempControl.setWakeCallback(wakeTemperatureTask);
 	display.init();
-	wifi.init();
-	encoder.init();
+	telemetryLog.init();
+	encoder.init(onEncoderInput, onEncoderDeferredInput);
 	digitalWrite(GPIO_CONTROL, LOW);
 	scheduler.load();
+	scheduler.begin(wakeScheduleTask);
+	timeManager.setClockChangeCallback(wakeScheduleTask);
+
+	// Бюджеты в мкс: превышение учитывается как overrun
+	temperatureTaskId = controlTasks.addTask("temp", temperatureTask, SENSOR_UPDATE_INTERVAL, 5000);
+	scheduleTaskId = controlTasks.addTask("schedule", scheduleTask, 0, 2000);
+	controlTasks.trigger(scheduleTaskId); // Начальная оценка и взвод таймера
+	controlTasks.addTask("sched_audit", scheduleAuditTask, SCHEDULE_AUDIT_INTERVAL, 2000);
+	controlTasks.addTask("history", historyTask, HISTORY_SAMPLE_INTERVAL, 500);
+	// Часы только что привязаны к DS3231 в init() - первая сверка через полный период
+	rtcSyncTaskId = controlTasks.addTask("rtc_sync", rtcResyncTask, RTC_RESYNC_INTERVAL, 2000);
+	controlTasks.scheduleIn(rtcSyncTaskId, RTC_RESYNC_INTERVAL);
+
+	webTaskId = networkTasks.addTask("web", webTask, 0, 5000);
+	networkTasks.addTask("ntp", ntpTask, NTP_POLL_INTERVAL, 2000);
+	networkTasks.addTask("log", logTask, LOG_POLL_INTERVAL, 50000);
+	networkTasks.addTask("stats", statsTask, TASK_STATS_INTERVAL, 0);
+
+	menuTaskId = uiTasks.addTask("menu", menuTask, DISPLAY_FRAME_INTERVAL, 30000);
+	uiTasks.addTask("tm1637", tm1637Task, TM1637_UPDATE_INTERVAL, 500);
+	tm1637StepTaskId = uiTasks.addTask("tm1637_io", tm1637StepTask, 0, 500);
+
+	// Управление - на APP_CPU с наивысшим приоритетом, сеть - на PRO_CPU рядом со стеком WiFi
+	xTaskCreatePinnedToCore(runScheduler, "control", CONTROL_TASK_STACK, &controlTasks,
+	                        CONTROL_TASK_PRIORITY, nullptr, APP_CPU_NUM);
+	xTaskCreatePinnedToCore(networkMain, "network", NETWORK_TASK_STACK, &networkTasks,
+	                        NETWORK_TASK_PRIORITY, nullptr, PRO_CPU_NUM);
+	xTaskCreatePinnedToCore(runScheduler, "ui", UI_TASK_STACK, &uiTasks,
+	                        UI_TASK_PRIORITY, nullptr, APP_CPU_NUM);
+	display.setFlushDoneCallback(onDisplayFlushed);
+	xTaskCreatePinnedToCore(oledFlushMain, "oled", OLED_TASK_STACK, nullptr,
+	                        OLED_TASK_PRIORITY, nullptr, APP_CPU_NUM);
 }
 
 void loop() {
-  encoder.update();
-  DateTime now = timeManager.getNow();
-  tempControl.update();
-  scheduler.checkSchedule(now);
-  wifi.handleClient();
-  menu.update();
-  display.updateTM1637(now, tempControl.getTemperature());
-  delay(100);
+  // Вся работа идет в задачах FreeRTOS
+  vTaskDelete(nullptr);
 }
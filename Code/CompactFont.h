@@ -0,0 +1,92 @@
+#pragma once
+#include <Arduino.h>
+
+// Компактный шрифт из fontsCompact.h (генерирует tools/fontsubset.py):
+//   height, glyphCount, firstCode, mapLength,
+//   map[mapLength]    - код CP1251 - firstCode -> номер глифа (0xFF - символа нет),
+//   glyphCount x 4    - смещение (2 байта), длина данных, ширина | RLE_FLAG,
+//   данные            - как в шрифтах библиотеки или, с RLE_FLAG, битовый RLE:
+//                       пиксели по столбцам сверху вниз (height бит на столбец),
+//                       чередующиеся серии фон/точки начиная с фона; длина серии -
+//                       группы по RUN_BITS бит старшим битом вперед, группа
+//                       RUN_CONTINUE продолжается следующей. Хвост фона не хранится.
+// Глиф после распаковки - тот же столбцовый формат, что и в шрифтах библиотеки.
+namespace CompactFont {
+
+const uint8_t HEADER_BYTES = 4;
+const uint8_t NO_GLYPH = 0xFF;
+const uint8_t RLE_FLAG = 0x80;
+const uint8_t MAX_GLYPH_BYTES = 128;
+const uint8_t RUN_BITS = 3;
+const uint8_t RUN_CONTINUE = (1 << RUN_BITS) - 1;
+
+struct Glyph {
+  const uint8_t* data;   // Данные глифа во флеше
+  uint8_t encodedBytes;  // 0 - пустой глиф (пробел)
+  uint8_t width;
+  bool compressed;
+};
+
+inline uint8_t height(const uint8_t* font) {
+  return pgm_read_byte(font);
+}
+
+// false - символа нет в подмножестве шрифта
+inline bool findGlyph(const uint8_t* font, uint8_t code, Glyph& glyph) {
+  uint8_t firstCode = pgm_read_byte(font + 2);
+  uint8_t mapLength = pgm_read_byte(font + 3);
+  if(code < firstCode || code - firstCode >= mapLength) return false;
+  uint8_t index = pgm_read_byte(font + HEADER_BYTES + code - firstCode);
+  if(index == NO_GLYPH) return false;
+  uint8_t glyphCount = pgm_read_byte(font + 1);
+  const uint8_t* entry = font + HEADER_BYTES + mapLength + index * 4;
+  const uint8_t* data = font + HEADER_BYTES + mapLength + glyphCount * 4;
+  glyph.data = data + ((pgm_read_byte(entry) << 8) | pgm_read_byte(entry + 1));
+  glyph.encodedBytes = pgm_read_byte(entry + 2);
+  uint8_t width = pgm_read_byte(entry + 3);
+  glyph.width = width & ~RLE_FLAG;
+  glyph.compressed = width & RLE_FLAG;
+  return true;
+}
+
+// Распаковка в out (size байт, остаток - нули, как в обрезанных глифах библиотеки)
+inline void decodeGlyph(const Glyph& glyph, uint8_t height, uint8_t* out, uint16_t size) {
+  memset(out, 0, size);
+  if(!glyph.compressed) {
+    for(uint16_t i = 0; i < glyph.encodedBytes && i < size; i++) {
+      out[i] = pgm_read_byte(glyph.data + i);
+    }
+    return;
+  }
+  uint8_t rasterHeight = 1 + ((height - 1) >> 3);
+  uint16_t totalBits = glyph.encodedBytes * 8;
+  uint16_t pixels = glyph.width * height;
+  uint16_t pixel = 0;   // Номер пикселя по столбцам
+  uint8_t x = 0;
+  uint8_t y = 0;
+  uint16_t run = 0;
+  bool ink = false;
+  for(uint16_t bit = 0; bit + RUN_BITS <= totalBits && pixel < pixels; bit += RUN_BITS) {
+    uint8_t group = 0;
+    for(uint8_t i = 0; i < RUN_BITS; i++) {
+      uint16_t position = bit + i;
+      group = (group << 1) | ((pgm_read_byte(glyph.data + (position >> 3)) >> (7 - (position & 7))) & 1);
+    }
+    run += group;
+    if(group == RUN_CONTINUE) continue;
+    for(; run > 0 && pixel < pixels; run--, pixel++) {
+      if(ink) {
+        uint16_t index = x * rasterHeight + (y >> 3);
+        if(index < size) out[index] |= 1 << (y & 7);
+      }
+      if(++y == height) {
+        y = 0;
+        x++;
+      }
+    }
+    run = 0;
+    ink = !ink;
+  }
+}
+
+} // namespace CompactFont
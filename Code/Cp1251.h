@@ -0,0 +1,67 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Строка уже в однобайтной кодировке шрифтов fontsRus.h (CP1251).
+// Рисуется как есть, без посимвольного вызова FontUtf8Rus.
+struct FontText {
+  const char* text;
+};
+
+// Перекодировка строковых литералов UTF-8 -> CP1251 на этапе компиляции.
+// Поддерживаются ASCII, А-Я, а-я, Ё и ё - как и в FontUtf8Rus; на любой
+// другой символ сборка падает (throw в constexpr-контексте).
+// Написано в стиле C++11: constexpr-функции из одного return.
+namespace cp1251 {
+
+constexpr uint8_t byteAt(const char* s, size_t i) {
+  return (uint8_t)s[i];
+}
+
+constexpr char decode(uint8_t lead, uint8_t next) {
+  return lead == 0xD0 && next == 0x81 ? (char)0xA8 :                // Ё
+         lead == 0xD0 && next >= 0x90 && next <= 0xBF ? (char)(next + 0x30) :
+         lead == 0xD1 && next == 0x91 ? (char)0xB8 :                // ё
+         lead == 0xD1 && next >= 0x80 && next <= 0x8F ? (char)(next + 0x70) :
+         throw "character is not in the CP1251 font";
+}
+
+// Позиция в исходной строке, с которой начинается out-й символ результата
+constexpr size_t sourceIndex(const char* s, size_t n, size_t out, size_t in = 0) {
+  return (out == 0 || in >= n) ? in
+       : sourceIndex(s, n, out - 1, in + (byteAt(s, in) >= 0xC0 ? 2 : 1));
+}
+
+constexpr char charAt(const char* s, size_t n, size_t in) {
+  return in >= n - 1 ? '\0'
+       : byteAt(s, in) < 0x80 ? s[in]
+       : decode(byteAt(s, in), byteAt(s, in + 1));
+}
+
+template<size_t N>
+struct Text {
+  char data[N];
+};
+
+template<size_t... I> struct Indices {};
+template<size_t N, size_t... I> struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+template<size_t... I> struct MakeIndices<0, I...> { typedef Indices<I...> type; };
+
+template<size_t N, size_t... I>
+constexpr Text<N> convert(const char (&utf8)[N], Indices<I...>) {
+  return Text<N>{{ charAt(utf8, N, sourceIndex(utf8, N, I))... }};
+}
+
+// Результат не длиннее исходника: хвост добивается нулями
+template<size_t N>
+constexpr Text<N> convert(const char (&utf8)[N]) {
+  return convert(utf8, typename MakeIndices<N>::type());
+}
+
+} // namespace cp1251
+
+// CP1251("Меню") - литерал, перекодированный при компиляции и лежащий во флеше
+#define CP1251(literal) ([]() -> FontText { \
+    static constexpr cp1251::Text<sizeof(literal)> converted = cp1251::convert(literal); \
+    return FontText{converted.data}; \
+  }())
@@ -1,9 +1,10 @@
 #pragma once
 
 #include "WiFiManager.h"
-#include <SSD1306Wire.h>
-#include <TM1637Display.h>
+#include "PartialSSD1306.h"
+#include "SegmentDisplay.h"
 #include "fontsRus.h"
+#include "fontsCompact.h"
 #include "RTCTimeManager.h"
 #include "RelayController.h"
 #include "Pins.h"
@@ -33,24 +34,30 @@ public:
 		  while(true);
 		}
 		oled.flipScreenVertically();
-		oled.setFont(ArialRus_Plain_10);
+		oled.invalidate(); // Первый кадр - целиком
+		// Подмножество ArialRus_Plain_10 из fontsCompact.h: полные таблицы fontsRus.h не попадают в прошивку
+		oled.setCompactFont(ArialRus_Plain_10_Compact);
 		oled.setFontTableLookupFunction(FontUtf8Rus);
 		
+		tmDisplay.begin();
 		tmDisplay.setBrightness(7);
 	}
   
   void drawMenu(const char** items, int count, int selectedIndex) {
 	oled.clear();
-	oled.drawString(LEFT_PADDING, TOP_PADDING, "======= Меню =======");
+	oled.drawString(LEFT_PADDING, TOP_PADDING, CP1251("======= Меню ======="));
 	
+	// Пункты меню уже в CP1251
 	for(int i = 0; i < count; i++) {
-	  String text = (i == selectedIndex) ? "> " + String(items[i]) : String(items[i]);
-	  oled.drawString(LEFT_PADDING, TOP_PADDING + (i+1)*LINE_HEIGHT, text);
+	  char text[LINE_CAPACITY];
+	  snprintf(text, sizeof(text), "%s%s", (i == selectedIndex) ? "> " : "", items[i]);
+	  oled.drawString(LEFT_PADDING, TOP_PADDING + (i+1)*LINE_HEIGHT, FontText{text});
 	}
-	oled.display();
+	flush();
   }
   
-  void drawMainScreen(const DateTime& now, float temp, bool overheatStatus, WiFiManager::WiFiState wifiState) {
+  void drawMainScreen(const DateTime& now, TempCenti temp, int32_t slope, int32_t predictedMs,
+                      bool overheatStatus, WiFiManager::WiFiState wifiState) {
 	oled.clear();
 	
 	// Строка 1: Время и день недели
@@ -60,74 +67,93 @@ public:
 			now.hour(), now.minute(), now.second(),
 			daysOfWeek[(now.dayOfTheWeek() + 6) % 7],
 			tzOffset);
-	oled.drawString(LEFT_PADDING, TOP_PADDING, datetime);
+	oled.drawString(LEFT_PADDING, TOP_PADDING, FontText{datetime});
 	
-	// Строка 2: Температура и статус
-	char tempStr[20];
-	snprintf(tempStr, sizeof(tempStr), "%.0fC %s", 
-			 temp, 
-		  overheatStatus ? "Перегрев" : "Норма");
-	oled.drawString(LEFT_PADDING, TOP_PADDING + LINE_HEIGHT, tempStr);
+	// Строка 2: Температура, скорость роста и статус (или прогноз до порога)
+	char tempStr[40];
+	char tempValue[8];
+	char slopeValue[12];
+	formatTemp(tempValue, sizeof(tempValue), temp, 0);
+	formatTemp(slopeValue, sizeof(slopeValue), slope, 1, true);
+	if (!overheatStatus && predictedMs >= 0 && predictedMs < 600000) {
+		snprintf(tempStr, sizeof(tempStr), CP1251("%sC %s/м порог %ldс").text, 
+				 tempValue, slopeValue, (long)(predictedMs / 1000));
+	} else {
+		snprintf(tempStr, sizeof(tempStr), CP1251("%sC %s/м %s").text, 
+				 tempValue, slopeValue,
+			  overheatStatus ? CP1251("Перегрев").text : CP1251("Норма").text);
+	}
+	oled.drawString(LEFT_PADDING, TOP_PADDING + LINE_HEIGHT, FontText{tempStr});
 	
 	// Строка 3: Состояние реле
-	String status;
+	FontText status;
 	if (relay.isBlocked()) {
-		status = "БЛОКИРОВКА";
+		status = CP1251("БЛОКИРОВКА");
 	} else {
-		status = scheduler->isActiveNow(timeManager.getNow()) ? "АКТИВНО" : "ОЖИДАНИЕ"; // Добавить метод isActiveNow
+		status = scheduler->isActiveNow(timeManager.getNow()) ? CP1251("АКТИВНО") : CP1251("ОЖИДАНИЕ"); // Добавить метод isActiveNow
 	}
 	oled.drawString(LEFT_PADDING, TOP_PADDING + 2*LINE_HEIGHT, status);
 	
 	// Строка 4: Статус Wi-Fi
-	String wifiStatus;
+	char wifiLine[LINE_CAPACITY];
 	switch(wifiState) {
-	  case WiFiManager::WiFiState::CONNECTED: wifiStatus = WiFi.SSID(); break;
-	  case WiFiManager::WiFiState::AP_MODE: wifiStatus = "Точка доступа"; break;
-	  default: wifiStatus = "Отключен";
+	  case WiFiManager::WiFiState::CONNECTED:
+		// SSID задает пользователь - эта строка декодируется из UTF-8 при отрисовке
+		snprintf(wifiLine, sizeof(wifiLine), "WiFi: %s", connectedSSID(wifiState));
+		oled.drawString(LEFT_PADDING, TOP_PADDING + 3*LINE_HEIGHT, wifiLine);
+		break;
+	  case WiFiManager::WiFiState::AP_MODE:
+		oled.drawString(LEFT_PADDING, TOP_PADDING + 3*LINE_HEIGHT, CP1251("WiFi: Точка доступа"));
+		break;
+	  default:
+		oled.drawString(LEFT_PADDING, TOP_PADDING + 3*LINE_HEIGHT, CP1251("WiFi: Отключен"));
 	}
-	oled.drawString(LEFT_PADDING, TOP_PADDING + 3*LINE_HEIGHT, "WiFi: " + wifiStatus);
 	
-	oled.display();
+	flush();
   }
 
 	void drawTemperatureCalibrationScreen(
-		float currentTemp, 
-		float calibratedTemp, 
-		float calibrationOffset,
+		TempCenti currentTemp, 
+		TempCenti calibratedTemp, 
+		TempCenti calibrationOffset,
 		TempEditField currentField
 	) {
 		oled.clear();
 		
 		// Заголовок
-		oled.drawString(LEFT_PADDING, TOP_PADDING, "=Кал-ка температуры=");
+		oled.drawString(LEFT_PADDING, TOP_PADDING, CP1251("=Кал-ка температуры="));
 		
 		// Исходное значение
 		char currentTempStr[40];
-		String currentPrefix = (currentField == EDIT_SOURCE) ? "> " : "  ";
-		snprintf(currentTempStr, sizeof(currentTempStr), "%sИст значение: %.1f", 
-				currentPrefix.c_str(), currentTemp);
-		oled.drawString(LEFT_PADDING, TOP_PADDING + LINE_HEIGHT, currentTempStr);
+		char value[8];
+		const char* currentPrefix = (currentField == EDIT_SOURCE) ? "> " : "  ";
+		formatTemp(value, sizeof(value), currentTemp);
+		snprintf(currentTempStr, sizeof(currentTempStr), CP1251("%sИст значение: %s").text, 
+				currentPrefix, value);
+		oled.drawString(LEFT_PADDING, TOP_PADDING + LINE_HEIGHT, FontText{currentTempStr});
 		
 		// Совмещенное значение
 		char calibratedTempStr[40];
-		snprintf(calibratedTempStr, sizeof(calibratedTempStr), "  Совм значение: %.1f", calibratedTemp);
-		oled.drawString(LEFT_PADDING, TOP_PADDING + 2*LINE_HEIGHT, calibratedTempStr);
+		formatTemp(value, sizeof(value), calibratedTemp);
+		snprintf(calibratedTempStr, sizeof(calibratedTempStr), CP1251("  Совм значение: %s").text, value);
+		oled.drawString(LEFT_PADDING, TOP_PADDING + 2*LINE_HEIGHT, FontText{calibratedTempStr});
 		
 		// Смещение
 		char offsetStr[40];
-		String offsetPrefix = (currentField == EDIT_OFFSET) ? "> " : "  ";
-		snprintf(offsetStr, sizeof(offsetStr), "%sЗнач смещения: %.1f", 
-				offsetPrefix.c_str(), calibrationOffset);
-		oled.drawString(LEFT_PADDING, TOP_PADDING + 3*LINE_HEIGHT, offsetStr);
+		const char* offsetPrefix = (currentField == EDIT_OFFSET) ? "> " : "  ";
+		formatTemp(value, sizeof(value), calibrationOffset);
+		snprintf(offsetStr, sizeof(offsetStr), CP1251("%sЗнач смещения: %s").text, 
+				offsetPrefix, value);
+		oled.drawString(LEFT_PADDING, TOP_PADDING + 3*LINE_HEIGHT, FontText{offsetStr});
 		
-		oled.display();
+		flush();
 	}
   
 	void drawTimeSetupScreen(const DateTime& time, TimeEditField currentField) {
 		oled.clear();
 		
 		// Заголовок
-		oled.drawString(LEFT_PADDING, TOP_PADDING, "Время и дата");
+		oled.drawString(LEFT_PADDING, TOP_PADDING, CP1251("Время и дата"));
 		
 		// Форматирование даты и времени
 		char dateStr[30];
@@ -149,50 +175,55 @@ public:
 				time.second());
 		
 		// Подсказка
-		String hint = (currentField == TIME_EDIT_CONFIRM) ? 
-		"> ЗАЖАТЬ - Сохранить" : 
-		"  Настройка...";
+		FontText hint = (currentField == TIME_EDIT_CONFIRM) ? 
+		CP1251("> ЗАЖАТЬ - Сохранить") : 
+		CP1251("  Настройка...");
 		
 		// Отрисовка
-		oled.drawString(LEFT_PADDING, TOP_PADDING + LINE_HEIGHT, dateStr);
-		oled.drawString(LEFT_PADDING, TOP_PADDING + 2*LINE_HEIGHT, timeStr);
+		oled.drawString(LEFT_PADDING, TOP_PADDING + LINE_HEIGHT, FontText{dateStr});
+		oled.drawString(LEFT_PADDING, TOP_PADDING + 2*LINE_HEIGHT, FontText{timeStr});
 		oled.drawString(LEFT_PADDING, TOP_PADDING + 3*LINE_HEIGHT, hint);
 		
-		oled.display();
+		flush();
 	}
 
-	void drawAPInfoScreen(const String& ssid, const String& pass, const String& ip) {
+	void drawAPInfoScreen(const char* ssid, const char* pass, const char* ip) {
+		char line[LINE_CAPACITY];
 		oled.clear();
-		oled.drawString(0, 0, "Режим Точки Доступа");
-		oled.drawString(0, 12, "SSID: " + ssid);
-		oled.drawString(0, 24, "Pass: " + pass);
-		oled.drawString(0, 36, "IP: " + ip);
-		oled.drawString(0, 48, "Кнопка - возврат");
-		oled.display();
+		oled.drawString(0, 0, CP1251("Режим Точки Доступа"));
+		snprintf(line, sizeof(line), "SSID: %s", ssid);
+		oled.drawString(0, 12, line);
+		snprintf(line, sizeof(line), "Pass: %s", pass);
+		oled.drawString(0, 24, line);
+		snprintf(line, sizeof(line), "IP: %s", ip);
+		oled.drawString(0, 36, FontText{line});
+		oled.drawString(0, 48, CP1251("Кнопка - возврат"));
+		flush();
 	}
 
 	void drawTimezoneSetupScreen(int currentOffset, bool editing) {
 		oled.clear();
 		
 		// Заголовок
-		oled.drawString(LEFT_PADDING, TOP_PADDING, "== Часовой пояс ==");
+		oled.drawString(LEFT_PADDING, TOP_PADDING, CP1251("== Часовой пояс =="));
 		
 		// Текущее смещение
 		char tzStr[30];
-		String prefix = editing ? "> " : "  ";
-		snprintf(tzStr, sizeof(tzStr), "%sСмещение: UTC%+d", 
-				prefix.c_str(), currentOffset);
-		oled.drawString(LEFT_PADDING, TOP_PADDING + LINE_HEIGHT, tzStr);
+		const char* prefix = editing ? "> " : "  ";
+		snprintf(tzStr, sizeof(tzStr), CP1251("%sСмещение: UTC%+d").text, 
+				prefix, currentOffset);
+		oled.drawString(LEFT_PADDING, TOP_PADDING + LINE_HEIGHT, FontText{tzStr});
 		
 		// Подсказка
-		String hint = editing ? "  Вращайте энкодер" : "> Нажмите для редакт.";
+		FontText hint = editing ? CP1251("  Вращайте энкодер") : CP1251("> Нажмите для редакт.");
 		oled.drawString(LEFT_PADDING, TOP_PADDING + 3*LINE_HEIGHT, hint);
 		
-		oled.display();
+		flush();
 	}
 
 	void drawScheduleSetupScreen(
 		uint8_t day,
+		uint8_t interval,
 		uint32_t start,
 		uint32_t stop,
 		int acceleration,
@@ -201,75 +232,81 @@ public:
 		oled.clear();
 		
 		// Заголовок
-		oled.drawString(LEFT_PADDING, TOP_PADDING, "Настройка расписания");
+		oled.drawString(LEFT_PADDING, TOP_PADDING, CP1251("Настройка расписания"));
 		
-		// День недели
-		String dayPrefix = (field == SCHEDULE_EDIT_DAY) ? "> " : "  ";
-		String dayStr = dayPrefix + "День: " + String(daysOfWeek[day]);
-		oled.drawString(LEFT_PADDING, TOP_PADDING + LINE_HEIGHT, dayStr);
+		// День недели и номер интервала
+		char dayStr[40];
+		snprintf(dayStr, sizeof(dayStr), CP1251("%sДень: %s  %sИнт: %d").text,
+				(field == SCHEDULE_EDIT_DAY) ? "> " : "  ",
+				daysOfWeek[day],
+				(field == SCHEDULE_EDIT_INTERVAL) ? ">" : " ",
+				interval + 1);
+		oled.drawString(LEFT_PADDING, TOP_PADDING + LINE_HEIGHT, FontText{dayStr});
 		
 		// Время старта
 		char startStr[30];
 		TimeSpan tsStart(start);
-		String startPrefix = (field == SCHEDULE_EDIT_START) ? "> " : "  ";
-		snprintf(startStr, sizeof(startStr), "%sСтарт: %02d:%02d", 
-				startPrefix.c_str(),
+		const char* startPrefix = (field == SCHEDULE_EDIT_START) ? "> " : "  ";
+		snprintf(startStr, sizeof(startStr), CP1251("%sСтарт: %02d:%02d").text, 
+				startPrefix,
 				tsStart.hours(), 
 				tsStart.minutes());
-		oled.drawString(LEFT_PADDING, TOP_PADDING + 2*LINE_HEIGHT, startStr);
+		oled.drawString(LEFT_PADDING, TOP_PADDING + 2*LINE_HEIGHT, FontText{startStr});
 		
 		// Время стопа
 		char stopStr[30];
-		TimeSpan tsStop(stop);
-		String stopPrefix = (field == SCHEDULE_EDIT_STOP) ? "> " : "  ";
-		snprintf(stopStr, sizeof(stopStr), "%sСтоп: %02d:%02d", 
-				stopPrefix.c_str(),
-				tsStop.hours(), 
-				tsStop.minutes());
-		oled.drawString(LEFT_PADDING, TOP_PADDING + 3*LINE_HEIGHT, stopStr);
+		const char* stopPrefix = (field == SCHEDULE_EDIT_STOP) ? "> " : "  ";
+		// Без TimeSpan: конец суток показывается как 24:00, а не 00:00
+		snprintf(stopStr, sizeof(stopStr), CP1251("%sСтоп: %02d:%02d").text, 
+				stopPrefix,
+				(int)(stop / 3600), 
+				(int)(stop % 3600 / 60));
+		oled.drawString(LEFT_PADDING, TOP_PADDING + 3*LINE_HEIGHT, FontText{stopStr});
 		
 		// Ускорениеы
 		char accelStr[30];
-		snprintf(accelStr, sizeof(accelStr), "  Ускорение: %d мин", 
+		snprintf(accelStr, sizeof(accelStr), CP1251("  Ускорение: %d мин").text, 
 				map(acceleration, 1, 6, 1, 30));
-		oled.drawString(LEFT_PADDING, TOP_PADDING + 4*LINE_HEIGHT, accelStr);
+		oled.drawString(LEFT_PADDING, TOP_PADDING + 4*LINE_HEIGHT, FontText{accelStr});
 		
-		oled.display();
+		flush();
 	}
 
-	void drawWiFiInfoScreen(const String& ssid, const String& ip, WiFiManager::WiFiState state) {
+	void drawWiFiInfoScreen(const char* ssid, const char* ip, WiFiManager::WiFiState state) {
 		oled.clear();
 		
 		// Заголовок
-		oled.drawString(LEFT_PADDING, TOP_PADDING, "== WiFi информация ==");
+		oled.drawString(LEFT_PADDING, TOP_PADDING, CP1251("== WiFi информация =="));
 		
 		// Строка 1: SSID сети
-		String ssidLine = "SSID: " + (ssid.length() > 0 ? ssid : "-");
-		oled.drawString(LEFT_PADDING, TOP_PADDING + LINE_HEIGHT, ssidLine);
+		char line[LINE_CAPACITY];
+		snprintf(line, sizeof(line), "SSID: %s", ssid[0] ? ssid : "-");
+		oled.drawString(LEFT_PADDING, TOP_PADDING + LINE_HEIGHT, line);
 		
 		// Строка 2: IP-адрес
-		String ipLine = "IP: " + (ip.length() > 0 ? ip : "-");
-		oled.drawString(LEFT_PADDING, TOP_PADDING + 2*LINE_HEIGHT, ipLine);
+		snprintf(line, sizeof(line), "IP: %s", ip[0] ? ip : "-");
+		oled.drawString(LEFT_PADDING, TOP_PADDING + 2*LINE_HEIGHT, FontText{line});
 		
 		// Строка 3: Статус
-		String status;
+		FontText status;
 		switch(state) {
 			case WiFiManager::WiFiState::CONNECTED: 
-				status = "Подключено";
+				status = CP1251("Подключено");
 				break;
 			case WiFiManager::WiFiState::AP_MODE: 
-				status = "Режим точки";
+				status = CP1251("Режим точки");
 				break;
 			case WiFiManager::WiFiState::DISCONNECTED:
 			default: 
-				status = "Отключено";
+				status = CP1251("Отключено");
 		}
-		oled.drawString(LEFT_PADDING, TOP_PADDING + 3*LINE_HEIGHT, "Статус: " + status);
+		snprintf(line, sizeof(line), CP1251("Статус: %s").text, status.text);
+		oled.drawString(LEFT_PADDING, TOP_PADDING + 3*LINE_HEIGHT, FontText{line});
 		
-		oled.display(); // Явное обновление дисплея
+		flush(); // Явное обновление дисплея
 	}
 
-	void updateTM1637(const DateTime& now, float temp) {
+	void updateTM1637(const DateTime& now, TempCenti temp) {
 		static bool showTemp = false;
 		static unsigned long lastSwitch = 0;
 	
@@ -291,6 +328,19 @@ public:
 		}
 	}
 
+	// Передача на TM1637 по частям; true - передача не закончена
+	bool stepTM1637() {
+		return tmDisplay.step();
+	}
+
+	bool isTM1637Pending() const {
+		return tmDisplay.isPending();
+	}
+
+	const SegmentDisplay::Stats& getTM1637Stats() const {
+		return tmDisplay.getStats();
+	}
+
   void showResetAnimation(float progress) {
 	  oled.clear();
 	
@@ -299,49 +349,92 @@ public:
 	  oled.fillRect(0, 20, barWidth, 10);
 	
 	  // Предупреждающий символ
-	  oled.setFont(ArialMT_Plain_24);
-	  oled.drawString(48, 40, "!");
+	  oled.setCompactFont(ArialRus_Plain_24_Compact);
+	  oled.drawString(48, 40, FontText{"!"});
+	  oled.setCompactFont(ArialRus_Plain_10_Compact);
 	
-	  oled.display();
+	  flush();
   }
   
-  void showDialog(const char* message, unsigned long duration) {
+  void showDialog(FontText message, unsigned long duration) {
 	  oled.clear();
 	  oled.drawString(0, 20, message);
-	  oled.display();
+	  flush();
 	  delay(duration);
   }
 
-  void showError(const char* message) {
+  void showError(FontText message) {
     oled.clear();
     oled.drawString(0, 0, message);
-    oled.display();
+    flush();
+  }
+
+  // Число готовых кадров, отданных на передачу, и статистика самой передачи
+  uint32_t getFlushCount() const {
+    return flushCount;
+  }
+
+  const PartialSSD1306::FlushStats& getFlushStats() const {
+    return oled.getFlushStats();
+  }
+
+  // Передача кадров по I2C - в отдельной задаче, отрисовка шину не ждет
+  void runFlushLoop() {
+    oled.runFlushLoop();
+  }
+
+  void setFlushDoneCallback(PartialSSD1306::FlushDoneCallback callback) {
+    oled.setFlushDoneCallback(callback);
+  }
+
+  // Досылка кадра, отложенного из-за идущей передачи
+  void submitDeferred() {
+    oled.submitDeferred();
   }
 
 private:
-  SSD1306Wire oled{0x3c, I2C_SDA, I2C_SCL};
-  TM1637Display tmDisplay{TM1637_CLK, TM1637_DIO};
+  PartialSSD1306 oled{0x3c, I2C_SDA, I2C_SCL};
+  SegmentDisplay tmDisplay{TM1637_CLK, TM1637_DIO};
   RelayController& relay;
   RTCTimeManager& timeManager;
   
   bool displayToggle = false;
   unsigned long lastDisplayUpdate = 0;
+  uint32_t flushCount = 0;
+  char ssidCache[33] = "";
+  WiFiManager::WiFiState ssidState = WiFiManager::WiFiState::DISCONNECTED;
   
   
   static constexpr int LINE_HEIGHT = 12;
   static constexpr int TOP_PADDING = 5;
   static constexpr int LEFT_PADDING = 5;
+  static constexpr size_t LINE_CAPACITY = 64; // Байт UTF-8 на строку экрана
   static constexpr unsigned long DISPLAY_UPDATE_INTERVAL = 2000;
-  static const char* daysOfWeek[7];
+  static const char* daysOfWeek[7]; // CP1251
+
+  // WiFi.SSID() возвращает String - перечитываем только при смене состояния WiFi
+  const char* connectedSSID(WiFiManager::WiFiState wifiState) {
+    if(wifiState != ssidState) {
+      strlcpy(ssidCache, WiFi.SSID().c_str(), sizeof(ssidCache));
+      ssidState = wifiState;
+    }
+    return ssidCache;
+  }
+
+  void flush() {
+    oled.display();
+    flushCount++;
+  }
 
   void displayTime(const DateTime& now) {
-    tmDisplay.showNumberDecEx(now.hour() * 100 + now.minute(), 0b01000000, true);
+    tmDisplay.showTime(now.hour(), now.minute());
   }
 
-  void displayTemperature(float temp) {
-    int16_t tempInt = round(temp * 10);
+  void displayTemperature(TempCenti temp) {
+    // Десятые доли с округлением от нуля
+    int16_t tempInt = (temp + (temp < 0 ? -5 : 5)) / 10;
     uint8_t data[4] = {
-      static_cast<uint8_t>(tempInt < 0 ? 0x40 : 0x00),
+      static_cast<uint8_t>(tempInt < 0 ? SegmentDisplay::MINUS : 0x00),
       tmDisplay.encodeDigit(abs(tempInt) / 100),
       tmDisplay.encodeDigit((abs(tempInt) / 10) % 10),
       static_cast<uint8_t>(0x63 | (abs(tempInt) % 10 << 4))
@@ -353,22 +446,21 @@ private:
 		DateTime nextOff = scheduler->getNextShutdownTime(now);
 		// Добавляем проверку на валидность времени
 		if(nextOff.year() == 1970) { // RTC default year
-			tmDisplay.showNumberDecEx(0, 0b01000000, true);
+			tmDisplay.showTime(0, 0);
 		} else {
-			tmDisplay.showNumberDecEx(
-				nextOff.hour() * 100 + nextOff.minute(), 
-				0b01000000, 
-				true
-			);
+			tmDisplay.showTime(nextOff.hour(), nextOff.minute());
 		}
 	}
 
 	void displayNextScheduleTime(const DateTime& now) {
 		DateTime nextOn = scheduler->getNextStartTime(now);
-		tmDisplay.showNumberDecEx(nextOn.hour() * 100 + nextOn.minute(), 0b01000000, true);
+		tmDisplay.showTime(nextOn.hour(), nextOn.minute());
 	}
 
 };
 
 // Инициализация статических членов
-const char* DisplayManager::daysOfWeek[] = {"ПН", "ВТ", "СР", "ЧТ", "ПТ", "СБ", "ВС"};
\ No newline at end of file
+const char* DisplayManager::daysOfWeek[] = {
+  CP1251("ПН").text, CP1251("ВТ").text, CP1251("СР").text, CP1251("ЧТ").text,
+  CP1251("ПТ").text, CP1251("СБ").text, CP1251("ВС").text
+};
\ No newline at end of file
@@ -1,7 +1,13 @@
 #pragma once
-#include <ESP32Encoder.h>
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "EventRing.h"
 #include "Pins.h"
 
+// Энкодер на прерываниях: обработчики GPIO складывают события
+// с метками времени в lock-free буфер, меню вычитывает их в update().
+// Кроме прерываний, писатель буфера - таймер повторного чтения кнопки
+// (задача esp_timer), поэтому запись идет под inputLock.
 class EncoderHandler {
 public:
   enum ButtonAction {
@@ -11,18 +17,65 @@ public:
     VERY_LONG_PRESS // >=20000ms
   };
 
-  EncoderHandler() : encoder() {}
+  enum EventType : uint8_t {
+    EVENT_ROTATE,
+    EVENT_PRESS,
+    EVENT_RELEASE
+  };
+
+  struct InputEvent {
+    EventType type;
+    int8_t delta;        // Для EVENT_ROTATE: +1/-1 щелчок
+    uint32_t timestampUs;
+  };
+
+  struct LatencyStats {
+    uint32_t samples = 0;
+    uint32_t maxUs = 0;
+    uint64_t totalUs = 0;
+  };
+
+  typedef void (*InputCallback)();
 
-  void init() {
-    encoder.attachSingleEdge(ENCODER_CLK, ENCODER_DT);
-    encoder.setFilter(1023);
+  EncoderHandler() {}
+
+  // onInput вызывается из прерывания (должен быть IRAM_ATTR),
+  // onTaskInput - из задачи esp_timer (повторное чтение кнопки)
+  void init(InputCallback onInput = nullptr, InputCallback onTaskInput = nullptr) {
+    inputCallback = onInput;
+    taskInputCallback = onTaskInput;
+    instance = this;
+    pinMode(ENCODER_CLK, INPUT_PULLUP);
+    pinMode(ENCODER_DT, INPUT_PULLUP);
     pinMode(ENCODER_SW, INPUT_PULLUP);
-    lastEncoderPos = encoder.getCount();
+    quadState = readQuadrature();
+    esp_timer_create_args_t args = {};
+    args.callback = onResampleTimer;
+    args.arg = this;
+    args.name = "btn_debounce";
+    esp_timer_create(&args, &resampleTimer);
+    attachInterrupt(digitalPinToInterrupt(ENCODER_CLK), onRotationEdge, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(ENCODER_DT), onRotationEdge, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(ENCODER_SW), onButtonEdge, CHANGE);
   }
 
+  // Вычитывает накопленные события из буфера прерываний
   void update() {
-    handleRotation();
-    handleButton();
+    InputEvent event;
+    while(events.pop(event)) {
+      if(pendingSinceUs == 0) {
+        pendingSinceUs = event.timestampUs | 1; // 0 означает "нет ожидающих"
+      }
+      switch(event.type) {
+        case EVENT_ROTATE:  handleRotation(event); break;
+        case EVENT_PRESS:   handlePress(event);    break;
+        case EVENT_RELEASE: handleRelease(event);  break;
+      }
+    }
+  }
+
+  bool hasInput() const {
+    return rotationDelta != 0 || currentAction != NONE || !events.isEmpty();
   }
 
   int getDelta() {
@@ -37,43 +90,157 @@ public:
     return action;
   }
 
+  // Скорость вращения в щелчках в секунду по реальным меткам времени
+  uint32_t getVelocity() const {
+    if(micros() - lastRotationUs > VELOCITY_TIMEOUT_US) return 0;
+    return velocity;
+  }
+
+  // Вызывается после отрисовки кадра: задержка "ввод -> экран"
+  void markRendered() {
+    if(pendingSinceUs == 0) return;
+    uint32_t latency = micros() - pendingSinceUs;
+    pendingSinceUs = 0;
+    latencyStats.samples++;
+    latencyStats.totalUs += latency;
+    if(latency > latencyStats.maxUs) {
+      latencyStats.maxUs = latency;
+    }
+  }
+
+  const LatencyStats& getLatencyStats() const {
+    return latencyStats;
+  }
+
+  uint32_t getDroppedEvents() const {
+    return events.getDropped();
+  }
+
 private:
-  ESP32Encoder encoder;
+  static constexpr uint32_t DEBOUNCE_US = 5000;
+  static constexpr uint32_t VELOCITY_TIMEOUT_US = 300000;
+
+  static EncoderHandler* instance;
+
+  EventRing<InputEvent, 32> events;
+  InputCallback inputCallback = nullptr;
+  InputCallback taskInputCallback = nullptr;
+  volatile uint8_t quadState = 0;
+  volatile int8_t quadSteps = 0;
+  volatile uint32_t lastButtonEdgeUs = 0;
+  volatile bool buttonLevel = true;
+  volatile bool resamplePending = false;
+  esp_timer_handle_t resampleTimer = nullptr;
+  portMUX_TYPE inputLock = portMUX_INITIALIZER_UNLOCKED;
+
   int rotationDelta = 0;
   ButtonAction currentAction = NONE;
-  long lastEncoderPos = 0;
   bool buttonPressed = false;
-  unsigned long buttonPressStart = 0;
+  uint32_t buttonPressStartUs = 0;
+  uint32_t lastRotationUs = 0;
+  uint32_t velocity = 0;
+  uint32_t pendingSinceUs = 0;
+  LatencyStats latencyStats;
+
+  static uint8_t IRAM_ATTR readQuadrature() {
+    uint32_t levels = REG_READ(GPIO_IN_REG);
+    return (((levels >> ENCODER_CLK) & 1) << 1) | ((levels >> ENCODER_DT) & 1);
+  }
+
+  static void IRAM_ATTR onRotationEdge() {
+    // Таблица переходов кода Грея: недопустимые переходы (дребезг) дают 0
+    static const int8_t transitions[16] = {
+      0, -1,  1,  0,
+      1,  0,  0, -1,
+     -1,  0,  0,  1,
+      0,  1, -1,  0
+    };
+    EncoderHandler* self = instance;
+    uint8_t state = readQuadrature();
+    self->quadSteps += transitions[(self->quadState << 2) | state];
+    self->quadState = state;
+
+    if(self->quadSteps >= ENCODER_TRANSITIONS_PER_DETENT ||
+       self->quadSteps <= -ENCODER_TRANSITIONS_PER_DETENT) {
+      InputEvent event = {EVENT_ROTATE, (int8_t)(self->quadSteps > 0 ? 1 : -1), (uint32_t)micros()};
+      self->quadSteps = 0;
+      portENTER_CRITICAL_ISR(&self->inputLock);
+      self->events.push(event);
+      portEXIT_CRITICAL_ISR(&self->inputLock);
+      if(self->inputCallback) self->inputCallback();
+    }
+  }
+
+  static void IRAM_ATTR onButtonEdge() {
+    portENTER_CRITICAL_ISR(&instance->inputLock);
+    bool accepted = instance->sampleButton();
+    portEXIT_CRITICAL_ISR(&instance->inputLock);
+    if(accepted && instance->inputCallback) instance->inputCallback();
+  }
+
+  // Окно дребезга закончилось - уровень читается заново: последний фронт
+  // внутри окна (например, отпускание сразу после нажатия) не теряется
+  static void onResampleTimer(void* arg) {
+    EncoderHandler* self = static_cast<EncoderHandler*>(arg);
+    portENTER_CRITICAL(&self->inputLock);
+    self->resamplePending = false;
+    bool accepted = self->sampleButton();
+    portEXIT_CRITICAL(&self->inputLock);
+    if(accepted && self->taskInputCallback) self->taskInputCallback();
+  }
 
-  void handleRotation() {
-    long newPos = encoder.getCount();
-    if (newPos != lastEncoderPos) {
-      rotationDelta += (newPos > lastEncoderPos) ? 1 : -1;
-      lastEncoderPos = newPos;
+  // Под inputLock. true - принят новый уровень кнопки
+  bool IRAM_ATTR sampleButton() {
+    uint32_t now = micros();
+    bool level = (REG_READ(GPIO_IN_REG) >> ENCODER_SW) & 1;
+    if(level == buttonLevel) return false;
+    uint32_t sinceEdge = now - lastButtonEdgeUs;
+    if(sinceEdge < DEBOUNCE_US) {
+      if(!resamplePending) {
+        resamplePending = true;
+        esp_timer_start_once(resampleTimer, DEBOUNCE_US - sinceEdge);
+      }
+      return false;
     }
+    buttonLevel = level;
+    lastButtonEdgeUs = now;
+    InputEvent event = {level ? EVENT_RELEASE : EVENT_PRESS, 0, now};
+    events.push(event);
+    return true;
   }
 
-  void handleButton() {
-    int btnState = digitalRead(ENCODER_SW);
-    
-    if (btnState == LOW && !buttonPressed) {
-      buttonPressed = true;
-      buttonPressStart = millis();
+  void handleRotation(const InputEvent& event) {
+    rotationDelta += event.delta; // Каждый щелчок учитывается
+    uint32_t interval = event.timestampUs - lastRotationUs;
+    if(interval >= VELOCITY_TIMEOUT_US) {
+      velocity = 0;
+    } else if(interval > 0) {
+      uint32_t instant = 1000000UL / interval;
+      velocity = velocity ? (velocity * 3 + instant) / 4 : instant;
     }
-    
-    if (btnState == HIGH && buttonPressed) {
-      buttonPressed = false;
-      unsigned long duration = millis() - buttonPressStart;
-      
-      if (duration > 50) { // Debounce
-        if (duration < 500) {
-          currentAction = SHORT_PRESS;
-        } else if (duration >= 1000 && duration < 20000) {
-          currentAction = LONG_PRESS;
-        } else if (duration >= 20000) {
-          currentAction = VERY_LONG_PRESS;
-        }
+    lastRotationUs = event.timestampUs;
+  }
+
+  void handlePress(const InputEvent& event) {
+    buttonPressed = true;
+    buttonPressStartUs = event.timestampUs;
+  }
+
+  void handleRelease(const InputEvent& event) {
+    if(!buttonPressed) return;
+    buttonPressed = false;
+    unsigned long duration = (event.timestampUs - buttonPressStartUs) / 1000;
+
+    if (duration > 50) { // Debounce
+      if (duration < 500) {
+        currentAction = SHORT_PRESS;
+      } else if (duration >= 1000 && duration < 20000) {
+        currentAction = LONG_PRESS;
+      } else if (duration >= 20000) {
+        currentAction = VERY_LONG_PRESS;
       }
     }
   }
-};
\ No newline at end of file
+};
+
+EncoderHandler* EncoderHandler::instance = nullptr;
@@ -0,0 +1,48 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+// Lock-free кольцевой буфер на одного писателя и одного читателя
+// (писатель - обработчик прерывания, читатель - задача).
+// N должно быть степенью двойки.
+template <typename T, uint16_t N>
+class EventRing {
+  static_assert((N & (N - 1)) == 0, "EventRing size must be a power of two");
+
+public:
+  bool IRAM_ATTR push(const T& item) {
+    uint16_t head = headIndex.load(std::memory_order_relaxed);
+    uint16_t next = (head + 1) & (N - 1);
+    if(next == tailIndex.load(std::memory_order_acquire)) {
+      droppedCount++;
+      return false; // Буфер полон - событие теряется, но учитывается
+    }
+    items[head] = item;
+    headIndex.store(next, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T& item) {
+    uint16_t tail = tailIndex.load(std::memory_order_relaxed);
+    if(tail == headIndex.load(std::memory_order_acquire)) {
+      return false;
+    }
+    item = items[tail];
+    tailIndex.store((tail + 1) & (N - 1), std::memory_order_release);
+    return true;
+  }
+
+  bool isEmpty() const {
+    return tailIndex.load(std::memory_order_acquire) == headIndex.load(std::memory_order_acquire);
+  }
+
+  uint32_t getDropped() const {
+    return droppedCount;
+  }
+
+private:
+  T items[N];
+  std::atomic<uint16_t> headIndex{0};
+  std::atomic<uint16_t> tailIndex{0};
+  volatile uint32_t droppedCount = 0;
+};
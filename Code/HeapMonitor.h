@@ -0,0 +1,85 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <atomic>
+
+// Счетчик выделений памяти в куче - проверка, что отрисовка кадра ее не трогает.
+// Каждое выделение наблюдаемой задачи считается в одной из сборок:
+//  - CONFIG_HEAP_USE_HOOKS (ESP-IDF): хук кучи на каждое выделение;
+//  - HEAP_MONITOR_WRAP_MALLOC и флаги компоновщика
+//    -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc
+//    (например, build_flags в PlatformIO).
+// В обычной сборке Arduino IDE этого нет, и sample() возвращает число занятых
+// блоков кучи. Разность таких замеров - только чистый прирост блоков, в нем
+// есть выделения других задач, а malloc с free внутри кадра не виден вовсе.
+// Отсутствия выделений он не доказывает, поэтому в статистике это net blocks.
+class HeapMonitor {
+public:
+#if defined(CONFIG_HEAP_USE_HOOKS) || defined(HEAP_MONITOR_WRAP_MALLOC)
+  static constexpr bool COUNTS_ALLOCATIONS = true;
+#else
+  static constexpr bool COUNTS_ALLOCATIONS = false;
+#endif
+
+  // Считать выделения только текущей задачи
+  static void watchCurrentTask() {
+    watchedTask.store(xTaskGetCurrentTaskHandle());
+  }
+
+  // COUNTS_ALLOCATIONS: разность двух замеров - число выделений между ними.
+  // Иначе - изменение числа занятых блоков кучи (net blocks).
+  static uint32_t sample() {
+#if defined(CONFIG_HEAP_USE_HOOKS) || defined(HEAP_MONITOR_WRAP_MALLOC)
+    return allocations.load();
+#else
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+    return info.allocated_blocks;
+#endif
+  }
+
+  static void IRAM_ATTR onAlloc() {
+    if(xTaskGetCurrentTaskHandle() == watchedTask.load()) {
+      allocations.fetch_add(1);
+    }
+  }
+
+private:
+  static std::atomic<TaskHandle_t> watchedTask;
+  static std::atomic<uint32_t> allocations;
+};
+
+// Инициализация статических членов
+std::atomic<TaskHandle_t> HeapMonitor::watchedTask{nullptr};
+std::atomic<uint32_t> HeapMonitor::allocations{0};
+
+#ifdef CONFIG_HEAP_USE_HOOKS
+// Вызываются кучей ESP-IDF на каждое выделение/освобождение
+extern "C" void IRAM_ATTR esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+  HeapMonitor::onAlloc();
+}
+
+extern "C" void IRAM_ATTR esp_heap_trace_free_hook(void* ptr) {}
+#elif defined(HEAP_MONITOR_WRAP_MALLOC)
+// Компоновщик направляет сюда все вызовы malloc/calloc/realloc, в том числе
+// из ядра Arduino (String) и библиотек; __real_* - исходные функции newlib
+extern "C" void* __real_malloc(size_t size);
+extern "C" void* __real_calloc(size_t count, size_t size);
+extern "C" void* __real_realloc(void* ptr, size_t size);
+
+extern "C" void* __wrap_malloc(size_t size) {
+  HeapMonitor::onAlloc();
+  return __real_malloc(size);
+}
+
+extern "C" void* __wrap_calloc(size_t count, size_t size) {
+  HeapMonitor::onAlloc();
+  return __real_calloc(count, size);
+}
+
+// realloc(ptr, 0) только освобождает
+extern "C" void* __wrap_realloc(void* ptr, size_t size) {
+  if(size != 0) HeapMonitor::onAlloc();
+  return __real_realloc(ptr, size);
+}
+#endif
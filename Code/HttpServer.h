@@ -0,0 +1,552 @@
+#pragma once
+#include <Arduino.h>
+#include <lwip/sockets.h>
+#include <functional>
+
+// Совместимые BSD-имена lwIP - макросы и совпадают с методами send()/poll().
+// Ниже вызываются только функции lwip_*.
+#undef send
+#undef poll
+
+// Неблокирующий HTTP/1.1-сервер на сокетах lwIP (замена WebServer).
+// poll() обрабатывает все соединения и сразу возвращается: принимает новые,
+// дочитывает запросы, отправляет ответы ровно столько, сколько берет сокет.
+// Медленный клиент занимает только свой слот, до MAX_CONNECTIONS соединений
+// обслуживаются одновременно. Keep-alive - по умолчанию для HTTP/1.1.
+//
+// Ожидание событий - waitForEvents() в отдельной задаче FreeRTOS (select):
+// poll() вызывается только когда какой-то сокет готов или истек таймаут.
+// Сами обработчики выполняются там, где вызван poll(), - в сетевой задаче.
+// waitForEvents() и poll() не должны выполняться одновременно.
+//
+// API обработчиков как у WebServer: on(), arg(), hasArg(), send().
+// Длинные ответы - sendChunked(): Producer вызывается по мере освобождения
+// сокета и возвращает 0 в конце, весь ответ в памяти не собирается.
+class HttpServer {
+public:
+  enum class Method : uint8_t {
+    ANY,
+    GET,
+    POST,
+    OTHER
+  };
+
+  typedef std::function<void()> Handler;
+  // Заполняет out не больше size байт; 0 - ответ закончен
+  typedef std::function<size_t(char* out, size_t size)> Producer;
+
+  struct Stats {
+    uint32_t accepted = 0;    // Принятые соединения
+    uint32_t requests = 0;
+    uint32_t reused = 0;      // Запросы по уже открытому соединению (keep-alive)
+    uint32_t timeouts = 0;    // Закрытые по простою
+    uint32_t errors = 0;      // Некорректные или слишком длинные запросы
+    uint32_t maxHandlerUs = 0;
+  };
+
+  static constexpr uint8_t MAX_CONNECTIONS = 4;
+  static constexpr uint8_t MAX_ROUTES = 16;
+  static constexpr uint16_t REQUEST_CAPACITY = 2048;  // Заголовки + тело запроса
+  static constexpr uint16_t CHUNK_CAPACITY = 1024;    // Порция chunked-ответа
+  static constexpr unsigned long IDLE_TIMEOUT = 5000; // мс без обмена
+
+  HttpServer(uint16_t port) : port(port) {}
+
+  // Повторная регистрация того же пути и метода игнорируется:
+  // как и в WebServer, действует первый обработчик
+  void on(const char* path, Method method, Handler handler) {
+    for(uint8_t i = 0; i < routeCount; i++) {
+      if(routes[i].method == method && strcmp(routes[i].path, path) == 0) return;
+    }
+    if(routeCount == MAX_ROUTES) return;
+    routes[routeCount].path = path;
+    routes[routeCount].method = method;
+    routes[routeCount].handler = handler;
+    routeCount++;
+  }
+
+  void on(const char* path, Handler handler) {
+    on(path, Method::ANY, handler);
+  }
+
+  // Повторный вызов ничего не делает
+  void begin() {
+    if(listener >= 0) return;
+    int fd = lwip_socket(AF_INET, SOCK_STREAM, 0);
+    if(fd < 0) return;
+    int enable = 1;
+    lwip_setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if(lwip_bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || lwip_listen(fd, MAX_CONNECTIONS) != 0) {
+      lwip_close(fd);
+      return;
+    }
+    setNonBlocking(fd);
+    listener = fd;
+  }
+
+  // Блокирует до готовности любого сокета или до timeoutMs
+  void waitForEvents(unsigned long timeoutMs) {
+    if(listener < 0) {
+      delay(timeoutMs);
+      return;
+    }
+    fd_set readable;
+    fd_set writable;
+    FD_ZERO(&readable);
+    FD_ZERO(&writable);
+    int maxFd = -1;
+    bool slotFree = false;
+    for(uint8_t i = 0; i < MAX_CONNECTIONS; i++) {
+      const Connection& c = connections[i];
+      if(c.fd < 0) {
+        slotFree = true;
+        continue;
+      }
+      FD_SET(c.fd, c.phase == Phase::WRITE ? &writable : &readable);
+      if(c.fd > maxFd) maxFd = c.fd;
+    }
+    // Без свободного слота новое соединение ждет в очереди listen
+    if(slotFree) {
+      FD_SET(listener, &readable);
+      if(listener > maxFd) maxFd = listener;
+    }
+    if(maxFd < 0) {
+      delay(timeoutMs);
+      return;
+    }
+    timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    lwip_select(maxFd + 1, &readable, &writable, nullptr, &timeout);
+  }
+
+  void poll() {
+    if(listener < 0) return;
+    acceptPending();
+    for(uint8_t i = 0; i < MAX_CONNECTIONS; i++) {
+      Connection& c = connections[i];
+      if(c.fd < 0) continue;
+      if(c.phase == Phase::READ) receive(c);
+      if(c.fd >= 0 && c.phase == Phase::WRITE) transmit(c);
+      serveBuffered(c); // Запросы, пришедшие вместе с отправленным ответом
+      if(c.fd >= 0 && millis() - c.lastActivity > IDLE_TIMEOUT) {
+        stats.timeouts++;
+        closeConnection(c);
+      }
+    }
+  }
+
+  // Есть ответы, переданные сокету не целиком
+  bool isSending() const {
+    for(uint8_t i = 0; i < MAX_CONNECTIONS; i++) {
+      if(connections[i].fd >= 0 && connections[i].phase == Phase::WRITE) return true;
+    }
+    return false;
+  }
+
+  // ---- Внутри обработчика ----
+
+  // Закрыть соединение после этого ответа (Connection: close). До send().
+  void closeAfterResponse() {
+    if(current) current->keepAlive = false;
+  }
+
+  Method method() const {
+    return current ? current->method : Method::OTHER;
+  }
+
+  bool hasArg(const String& name) const {
+    const char* value;
+    size_t length;
+    return findArg(name.c_str(), value, length);
+  }
+
+  // Аргумент из строки запроса или из тела формы; "" - нет такого
+  String arg(const String& name) const {
+    const char* value;
+    size_t length;
+    if(!findArg(name.c_str(), value, length)) return String();
+    return urlDecode(value, length);
+  }
+
+  void send(int code, const char* contentType, const String& content) {
+    if(!current) return;
+    Connection& c = *current;
+    c.outputLength = formatHead(c, code, contentType, false, content.length());
+    c.body = content;
+    c.responded = true;
+  }
+
+  void sendChunked(int code, const char* contentType, Producer producer) {
+    if(!current) return;
+    Connection& c = *current;
+    c.outputLength = formatHead(c, code, contentType, true, 0);
+    c.producer = producer;
+    c.responded = true;
+  }
+
+  const Stats& getStats() const {
+    return stats;
+  }
+
+private:
+  enum class Phase : uint8_t { READ, WRITE };
+
+  // Ошибки parseContentLength
+  static constexpr int32_t LENGTH_INVALID = -1;
+  static constexpr int32_t LENGTH_TOO_LARGE = -2;
+
+  struct Route {
+    const char* path = nullptr;
+    Method method = Method::ANY;
+    Handler handler;
+  };
+
+  struct Connection {
+    int fd = -1;
+    Phase phase = Phase::READ;
+    unsigned long lastActivity = 0;
+    uint16_t served = 0;           // Запросов по соединению
+
+    // Запрос: разбирается на месте, строки завершаются нулем
+    char request[REQUEST_CAPACITY + 1];
+    uint16_t received = 0;
+    uint16_t consumed = 0;         // Длина текущего запроса (заголовки + тело)
+    Method method = Method::OTHER;
+    const char* query = "";
+    const char* form = "";
+    bool keepAlive = true;
+
+    // Ответ: заголовок или рамка порции, затем тело, затем порции Producer
+    char output[CHUNK_CAPACITY + 16];
+    uint16_t outputLength = 0;
+    uint16_t outputSent = 0;
+    String body;
+    size_t bodySent = 0;
+    Producer producer;
+    bool responded = false;
+  };
+
+  uint16_t port;
+  int listener = -1;
+  Route routes[MAX_ROUTES];
+  uint8_t routeCount = 0;
+  Connection connections[MAX_CONNECTIONS];
+  Connection* current = nullptr;
+  Stats stats;
+
+  static void setNonBlocking(int fd) {
+    lwip_fcntl(fd, F_SETFL, lwip_fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  }
+
+  static bool wouldBlock() {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+  }
+
+  void acceptPending() {
+    for(uint8_t i = 0; i < MAX_CONNECTIONS; i++) {
+      Connection& c = connections[i];
+      if(c.fd >= 0) continue;
+      int fd = lwip_accept(listener, nullptr, nullptr);
+      if(fd < 0) return;
+      setNonBlocking(fd);
+      int enable = 1;
+      lwip_setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+      c.fd = fd;
+      c.phase = Phase::READ;
+      c.received = 0;
+      c.served = 0;
+      c.lastActivity = millis();
+      stats.accepted++;
+    }
+  }
+
+  void closeConnection(Connection& c) {
+    lwip_close(c.fd);
+    c.fd = -1;
+    c.body = String();
+    c.producer = nullptr;
+  }
+
+  void receive(Connection& c) {
+    while(c.received < REQUEST_CAPACITY) {
+      int n = lwip_recv(c.fd, c.request + c.received, REQUEST_CAPACITY - c.received, MSG_DONTWAIT);
+      if(n == 0 || (n < 0 && !wouldBlock())) {
+        closeConnection(c); // Клиент закрыл соединение
+        return;
+      }
+      if(n < 0) break;
+      c.received += n;
+      c.lastActivity = millis();
+    }
+    serveBuffered(c);
+  }
+
+  // Обработать все запросы, уже лежащие в буфере (pipelining)
+  void serveBuffered(Connection& c) {
+    while(c.fd >= 0 && c.phase == Phase::READ && c.received > 0) {
+      uint16_t served = c.served;
+      processRequest(c);
+      if(c.served == served && c.phase == Phase::READ) return; // Запрос еще не пришел целиком
+    }
+  }
+
+  // Если запрос в буфере целиком - разобрать и вызвать обработчик.
+  // Пока запрос не пришел полностью, буфер не меняется.
+  void processRequest(Connection& c) {
+    c.request[c.received] = '\0';
+    char* headEnd = strstr(c.request, "\r\n\r\n");
+    if(headEnd == nullptr) {
+      if(c.received == REQUEST_CAPACITY) reject(c, 431);
+      return;
+    }
+    char* bodyStart = headEnd + 4;
+    uint16_t headLength = bodyStart - c.request;
+    int32_t contentLength = parseContentLength(headerValue(c.request, headEnd, "Content-Length"));
+    if(contentLength < 0) {
+      reject(c, contentLength == LENGTH_TOO_LARGE ? 413 : 400);
+      return;
+    }
+    // Длина уже не больше буфера, сумма не переполняется
+    if(headLength + (uint32_t)contentLength > REQUEST_CAPACITY) {
+      reject(c, 413);
+      return;
+    }
+    if(c.received < headLength + contentLength) return; // Тело еще не пришло
+    c.consumed = headLength + contentLength;
+
+    // Строка запроса: METHOD SP target SP HTTP/1.x
+    const char* connection = headerValue(c.request, headEnd, "Connection");
+    bool closeRequested = connection && strncasecmp(connection, "close", 5) == 0;
+    bool keepAliveRequested = connection && strncasecmp(connection, "keep-alive", 10) == 0;
+    char* lineEnd = strstr(c.request, "\r\n");
+    *lineEnd = '\0';
+    char* target = strchr(c.request, ' ');
+    char* version = target ? strchr(target + 1, ' ') : nullptr;
+    if(!target || !version) {
+      reject(c, 400);
+      return;
+    }
+    *target++ = '\0';
+    *version++ = '\0';
+    c.method = strcmp(c.request, "GET") == 0 ? Method::GET
+             : strcmp(c.request, "POST") == 0 ? Method::POST : Method::OTHER;
+    // HTTP/1.1 - keep-alive, если клиент не просит закрыть; HTTP/1.0 - только по запросу
+    c.keepAlive = strcmp(version, "HTTP/1.1") == 0 ? !closeRequested : keepAliveRequested;
+
+    char* query = strchr(target, '?');
+    if(query) *query++ = '\0';
+    c.query = query ? query : "";
+    // Тело - поля формы (application/x-www-form-urlencoded), за ним может идти следующий запрос
+    char saved = bodyStart[contentLength];
+    bodyStart[contentLength] = '\0';
+    c.form = bodyStart;
+
+    dispatch(c, target);
+    bodyStart[contentLength] = saved;
+    transmit(c); // После восстановления буфера: в конце ответа он сдвигается
+  }
+
+  // Content-Length: только десятичные цифры, не больше REQUEST_CAPACITY.
+  // Без заголовка - 0; "-1", "12abc" и пустое значение - LENGTH_INVALID.
+  // Цифры считаются до переполнения буфера, а не до переполнения типа.
+  static int32_t parseContentLength(const char* value) {
+    if(value == nullptr) return 0;
+    if(*value < '0' || *value > '9') return LENGTH_INVALID;
+    int32_t length = 0;
+    for(; *value >= '0' && *value <= '9'; value++) {
+      length = length * 10 + (*value - '0');
+      if(length > REQUEST_CAPACITY) return LENGTH_TOO_LARGE;
+    }
+    while(*value == ' ' || *value == '\t') value++;
+    return (*value == '\r') ? length : LENGTH_INVALID;
+  }
+
+  // Значение заголовка (до конца строки) или nullptr
+  static const char* headerValue(const char* head, const char* headEnd, const char* name) {
+    size_t nameLength = strlen(name);
+    const char* line = strstr(head, "\r\n");
+    while(line && line < headEnd) {
+      line += 2;
+      if(strncasecmp(line, name, nameLength) == 0 && line[nameLength] == ':') {
+        const char* value = line + nameLength + 1;
+        while(*value == ' ') value++;
+        return value;
+      }
+      line = strstr(line, "\r\n");
+    }
+    return nullptr;
+  }
+
+  void dispatch(Connection& c, const char* path) {
+    stats.requests++;
+    if(c.served++ > 0) stats.reused++;
+    c.responded = false;
+    c.outputSent = 0;
+    c.bodySent = 0;
+
+    const Route* route = nullptr;
+    for(uint8_t i = 0; i < routeCount && !route; i++) {
+      if(strcmp(routes[i].path, path) == 0 &&
+         (routes[i].method == Method::ANY || routes[i].method == c.method)) {
+        route = &routes[i];
+      }
+    }
+
+    current = &c;
+    unsigned long startUs = micros();
+    if(route) {
+      route->handler();
+    } else {
+      send(404, "text/plain", "Not found");
+    }
+    uint32_t elapsed = micros() - startUs;
+    if(elapsed > stats.maxHandlerUs) stats.maxHandlerUs = elapsed;
+    if(!c.responded) send(500, "text/plain", "No response");
+    current = nullptr;
+    c.phase = Phase::WRITE;
+  }
+
+  void reject(Connection& c, int code) {
+    const char* reason = statusText(code);
+    stats.errors++;
+    c.keepAlive = false;
+    c.consumed = c.received;
+    c.outputSent = 0;
+    c.bodySent = 0;
+    c.outputLength = formatHead(c, code, "text/plain", false, strlen(reason));
+    c.body = reason;
+    c.phase = Phase::WRITE;
+    transmit(c);
+  }
+
+  uint16_t formatHead(Connection& c, int code, const char* contentType, bool chunked, size_t length) {
+    int written = snprintf(c.output, sizeof(c.output), "HTTP/1.1 %d %s\r\nContent-Type: %s\r\n",
+                           code, statusText(code), contentType);
+    if(chunked) {
+      written += snprintf(c.output + written, sizeof(c.output) - written, "Transfer-Encoding: chunked\r\n");
+    } else {
+      written += snprintf(c.output + written, sizeof(c.output) - written, "Content-Length: %u\r\n", (unsigned)length);
+    }
+    written += snprintf(c.output + written, sizeof(c.output) - written, "Connection: %s\r\n\r\n",
+                        c.keepAlive ? "keep-alive" : "close");
+    return written;
+  }
+
+  static const char* statusText(int code) {
+    switch(code) {
+      case 200: return "OK";
+      case 400: return "Bad Request";
+      case 404: return "Not Found";
+      case 413: return "Payload Too Large";
+      case 431: return "Request Header Fields Too Large";
+      default: return "Error";
+    }
+  }
+
+  // Отправить столько, сколько принимает сокет
+  void transmit(Connection& c) {
+    for(;;) {
+      const char* data;
+      size_t length;
+      if(c.outputSent < c.outputLength) {
+        data = c.output + c.outputSent;
+        length = c.outputLength - c.outputSent;
+      } else if(c.bodySent < c.body.length()) {
+        data = c.body.c_str() + c.bodySent;
+        length = c.body.length() - c.bodySent;
+      } else if(c.producer) {
+        nextChunk(c);
+        continue;
+      } else {
+        finishResponse(c);
+        return;
+      }
+
+      int n = lwip_send(c.fd, data, length, MSG_DONTWAIT);
+      if(n < 0) {
+        if(!wouldBlock()) closeConnection(c);
+        return;
+      }
+      if(c.outputSent < c.outputLength) c.outputSent += n;
+      else c.bodySent += n;
+      c.lastActivity = millis();
+    }
+  }
+
+  // Следующая порция chunked-ответа в output: "<размер>\r\n<данные>\r\n"
+  void nextChunk(Connection& c) {
+    const uint8_t prefix = 6; // До 3 hex-цифр + \r\n, с запасом
+    size_t length = c.producer(c.output + prefix, CHUNK_CAPACITY);
+    c.outputSent = 0;
+    if(length == 0) {
+      c.producer = nullptr;
+      c.outputLength = snprintf(c.output, sizeof(c.output), "0\r\n\r\n");
+      return;
+    }
+    char size[prefix + 1];
+    uint8_t sizeLength = snprintf(size, sizeof(size), "%x\r\n", (unsigned)length);
+    uint8_t offset = prefix - sizeLength;
+    memcpy(c.output + offset, size, sizeLength);
+    memcpy(c.output + prefix + length, "\r\n", 2);
+    c.outputSent = offset;
+    c.outputLength = prefix + length + 2;
+  }
+
+  void finishResponse(Connection& c) {
+    c.body = String();
+    if(!c.keepAlive) {
+      closeConnection(c);
+      return;
+    }
+    // Следующий запрос мог прийти вместе с этим (pipelining)
+    c.received -= c.consumed;
+    memmove(c.request, c.request + c.consumed, c.received);
+    c.consumed = 0;
+    c.phase = Phase::READ;
+  }
+
+  // Поиск name=value в строке запроса, затем в теле формы
+  bool findArg(const char* name, const char*& value, size_t& length) const {
+    if(!current) return false;
+    return findIn(current->query, name, value, length) || findIn(current->form, name, value, length);
+  }
+
+  static bool findIn(const char* fields, const char* name, const char*& value, size_t& length) {
+    size_t nameLength = strlen(name);
+    const char* field = fields;
+    while(*field) {
+      const char* end = strchr(field, '&');
+      if(!end) end = field + strlen(field);
+      if((size_t)(end - field) >= nameLength && strncmp(field, name, nameLength) == 0 &&
+         (field + nameLength == end || field[nameLength] == '=')) {
+        value = field + nameLength + (field + nameLength == end ? 0 : 1);
+        length = end - value;
+        return true;
+      }
+      field = *end ? end + 1 : end;
+    }
+    return false;
+  }
+
+  static String urlDecode(const char* text, size_t length) {
+    String decoded;
+    decoded.reserve(length);
+    for(size_t i = 0; i < length; i++) {
+      if(text[i] == '+') {
+        decoded += ' ';
+      } else if(text[i] == '%' && i + 2 < length && isxdigit(text[i + 1]) && isxdigit(text[i + 2])) {
+        char hex[3] = {text[i + 1], text[i + 2], '\0'};
+        decoded += (char)strtol(hex, nullptr, 16);
+        i += 2;
+      } else {
+        decoded += text[i];
+      }
+    }
+    return decoded;
+  }
+};
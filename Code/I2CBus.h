@@ -0,0 +1,174 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#include "Pins.h"
+
+// Общая шина I2C (I2C_SDA/I2C_SCL): DS3231 и SSD1306.
+// Любое обращение к Wire идет внутри транзакции I2CBus::Transaction.
+// Шиной владеет одна задача; при освобождении она передается ожидающему
+// с наивысшим приоритетом, при равных - пришедшему первым.
+// Кадр OLED передается короткими транзакциями PRIORITY_BULK (команды окна
+// или до DATA_CHUNK байт данных), поэтому чтение часов ждет не дольше одной
+// такой порции, а не всего кадра.
+// Транзакции не вкладываются: внутри транзакции нельзя открыть вторую.
+class I2CBus {
+public:
+  enum Priority : uint8_t {
+    PRIORITY_URGENT = 0,  // Чтение времени и данных для защитных решений
+    PRIORITY_NORMAL = 1,  // Запись часов, команды панели
+    PRIORITY_BULK = 2     // Данные кадра OLED
+  };
+
+  enum Device : uint8_t {
+    DEVICE_RTC = 0,
+    DEVICE_OLED,
+    DEVICE_COUNT
+  };
+
+  struct DeviceStats {
+    uint32_t transactions = 0;
+    uint64_t busyUs = 0;     // Суммарное время владения шиной
+    uint32_t maxHoldUs = 0;
+    uint32_t waits = 0;      // Транзакции, ждавшие освобождения шины
+    uint32_t maxWaitUs = 0;
+  };
+
+  // Владение шиной на время жизни объекта
+  class Transaction {
+  public:
+    Transaction(Device device, Priority priority) : device(device) {
+      acquire(device, priority);
+    }
+
+    ~Transaction() {
+      release(device);
+    }
+
+  private:
+    Device device;
+  };
+
+  // До первого обращения к Wire (RTClib и SSD1306Wire повторно шину не запускают)
+  static void begin() {
+    for(uint8_t i = 0; i < MAX_WAITERS; i++) {
+      waiters[i].wake = xSemaphoreCreateBinary();
+    }
+    Wire.begin(I2C_SDA, I2C_SCL, I2C_BUS_CLOCK);
+  }
+
+  static void acquire(Device device, Priority priority) {
+    unsigned long requestUs = micros();
+    bool waited = false;
+    for(;;) {
+      int8_t slot = NO_SLOT;
+      portENTER_CRITICAL(&lock);
+      bool granted = !owned;
+      if(granted) {
+        owned = true;
+      } else {
+        slot = enqueue(priority);
+      }
+      portEXIT_CRITICAL(&lock);
+      if(granted) break;
+
+      waited = true;
+      if(slot != NO_SLOT) {
+        // release() передает шину напрямую, owned не сбрасывается
+        xSemaphoreTake(waiters[slot].wake, portMAX_DELAY);
+        portENTER_CRITICAL(&lock);
+        waiters[slot].state = FREE;
+        portEXIT_CRITICAL(&lock);
+        break;
+      }
+      vTaskDelay(1); // Все места в очереди заняты
+    }
+
+    // Статистику меняет только владелец шины
+    holdStartUs = micros();
+    if(waited) {
+      DeviceStats& entry = stats[device];
+      uint32_t waitedUs = holdStartUs - requestUs;
+      entry.waits++;
+      if(waitedUs > entry.maxWaitUs) entry.maxWaitUs = waitedUs;
+    }
+  }
+
+  static void release(Device device) {
+    uint32_t heldUs = micros() - holdStartUs;
+    DeviceStats& entry = stats[device];
+    entry.transactions++;
+    entry.busyUs += heldUs;
+    if(heldUs > entry.maxHoldUs) entry.maxHoldUs = heldUs;
+
+    portENTER_CRITICAL(&lock);
+    int8_t next = dequeue();
+    if(next == NO_SLOT) owned = false;
+    portEXIT_CRITICAL(&lock);
+    if(next != NO_SLOT) {
+      xSemaphoreGive(waiters[next].wake);
+    }
+  }
+
+  static const DeviceStats& getStats(Device device) {
+    return stats[device];
+  }
+
+private:
+  enum WaiterState : uint8_t { FREE, WAITING, GRANTED };
+
+  // Задачи, обращающиеся к шине: управление, сеть, UI, передача OLED
+  static constexpr uint8_t MAX_WAITERS = 6;
+  static constexpr int8_t NO_SLOT = -1;
+
+  struct Waiter {
+    SemaphoreHandle_t wake = nullptr;
+    uint32_t ticket = 0;
+    Priority priority = PRIORITY_BULK;
+    WaiterState state = FREE;
+  };
+
+  static portMUX_TYPE lock;
+  static bool owned;
+  static uint32_t nextTicket;
+  static unsigned long holdStartUs;
+  static Waiter waiters[MAX_WAITERS];
+  static DeviceStats stats[DEVICE_COUNT];
+
+  // Под lock. Слот освобождает сам ожидающий, когда проснется:
+  // иначе чужая задача могла бы забрать его семафор.
+  static int8_t enqueue(Priority priority) {
+    for(uint8_t i = 0; i < MAX_WAITERS; i++) {
+      if(waiters[i].state == FREE && waiters[i].wake != nullptr) {
+        waiters[i].state = WAITING;
+        waiters[i].priority = priority;
+        waiters[i].ticket = nextTicket++;
+        return i;
+      }
+    }
+    return NO_SLOT;
+  }
+
+  // Под lock
+  static int8_t dequeue() {
+    int8_t best = NO_SLOT;
+    for(uint8_t i = 0; i < MAX_WAITERS; i++) {
+      if(waiters[i].state != WAITING) continue;
+      if(best == NO_SLOT
+         || waiters[i].priority < waiters[best].priority
+         || (waiters[i].priority == waiters[best].priority
+             && (int32_t)(waiters[i].ticket - waiters[best].ticket) < 0)) {
+        best = i;
+      }
+    }
+    if(best != NO_SLOT) waiters[best].state = GRANTED;
+    return best;
+  }
+};
+
+// Инициализация статических членов
+portMUX_TYPE I2CBus::lock = portMUX_INITIALIZER_UNLOCKED;
+bool I2CBus::owned = false;
+uint32_t I2CBus::nextTicket = 0;
+unsigned long I2CBus::holdStartUs = 0;
+I2CBus::Waiter I2CBus::waiters[I2CBus::MAX_WAITERS];
+I2CBus::DeviceStats I2CBus::stats[I2CBus::DEVICE_COUNT];
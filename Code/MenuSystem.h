@@ -6,6 +6,8 @@
 #include "ScheduleManager.h"
 #include "WiFiManager.h"
 #include "TemperatureControl.h"
+#include "SharedState.h"
+#include "HeapMonitor.h"
 
 class DisplayManager;
 
@@ -23,32 +25,82 @@ public:
     RESET_ANIMATION
   };
 
+  // Входные данные экранов. Экран перерисовывается и отправляется на OLED,
+  // только если изменилось то, от чего он зависит, или был ввод с энкодера.
+  enum Dependency : uint8_t {
+    DEP_SECONDS     = 0x01,
+    DEP_TEMPERATURE = 0x02,
+    DEP_RELAY       = 0x04,
+    DEP_WIFI        = 0x08,
+    DEP_ALWAYS      = 0x80  // Анимация: каждый кадр
+  };
+
+  struct RenderStats {
+    uint32_t frames = 0;    // Вызовы update()
+    uint32_t redraws = 0;   // Из них с отрисовкой
+    // По HeapMonitor::sample(): выделения памяти во время отрисовки или,
+    // без счета выделений, прирост занятых блоков кучи (net blocks)
+    uint32_t heapCount = 0;
+    uint32_t heapFrames = 0;       // Кадры, во время которых счетчик изменился
+  };
+
 MenuSystem(DisplayManager& display, EncoderHandler& encoder, 
 		   RTCTimeManager& rtc, ScheduleManager& schedule,
-		   WiFiManager& wifi, TemperatureControl& temp)
+		   WiFiManager& wifi, TemperatureControl& temp,
+		   const SharedState& state, const RelayController& relay)
       : display(display), encoder(encoder), rtc(rtc),
-      schedule(schedule), wifi(wifi), temp(temp) {}
+      schedule(schedule), wifi(wifi), temp(temp), state(state), relay(relay) {}
 
   void update() {
+    HeapMonitor::watchCurrentTask();
     handleEncoder();
     updateDisplay();
+    display.submitDeferred(); // Буфер отрисовки сейчас содержит законченный кадр
+    encoder.markRendered(); // Учет задержки "ввод -> экран"
+  }
+
+  // Принудительная перерисовка на следующем кадре
+  void invalidate() {
+    redrawPending = true;
+  }
+
+  const RenderStats& getRenderStats() const {
+    return renderStats;
   }
 
 private:
+  // Значения входов в том виде, в каком они видны на экране
+  struct RenderInputs {
+    uint32_t epoch = 0;
+    int16_t temperature = 0;     // Целые градусы
+    int16_t slope = 0;           // Десятые °C/мин
+    int32_t predictedSeconds = -1;
+    bool overheated = false;
+    bool relayOn = false;
+    bool blocked = false;
+    WiFiManager::WiFiState wifiState = WiFiManager::WiFiState::DISCONNECTED;
+  };
+
+  RenderInputs renderedInputs;
+  State renderedState = RESET_ANIMATION;
+  bool redrawPending = true;
+  RenderStats renderStats;
+
   WiFiManager::WiFiState wifiStateCache;
   String ssidCache;
   String ipCache;
-  float currentOffset = 0.0;
-  float calibrationSource = 0.0;
+  TempCenti currentOffset = 0;
+  TempCenti calibrationSource = 0;
   TempEditField currentTempField = EDIT_OFFSET;
   int timezoneOffset = 3;
   bool editingTimezone = false;
   ScheduleEditField currentScheduleField = SCHEDULE_EDIT_DAY;
 	uint8_t currentDay = 0;
-	uint32_t startTime = 0;
-	uint32_t stopTime = 0;
+	uint8_t currentInterval = 0;
+	// Интервалы редактируемого дня; start == stop - слот пуст
+	uint32_t slotStart[ScheduleManager::MAX_INTERVALS] = {0};
+	uint32_t slotStop[ScheduleManager::MAX_INTERVALS] = {0};
 	int acceleration = 0;
-	unsigned long lastEncoderMove = 0;
 
   DateTime editingTime; // Временная переменная для редактирования времени
   TimeEditField currentEditField = TIME_EDIT_YEAR; 
@@ -61,22 +113,28 @@ private:
   ScheduleManager& schedule;
   WiFiManager& wifi;
   TemperatureControl& temp;
+  const SharedState& state; // Показания берем из снимка, а не с шины датчика
+  const RelayController& relay;
   
   State currentState = MAIN_SCREEN;
   int menuIndex = 0;
   unsigned long resetStartTime = 0;
-  const char* mainMenuItems[6] = {
-    "Настройка времени",
-    "Установка расписания",
-    "Информация о WiFi",
-    "Калиб-ка температуры",
-    "Часовой пояс",
-    "Выход"
+  const char* mainMenuItems[6] = { // CP1251, см. Cp1251.h
+    CP1251("Настройка времени").text,
+    CP1251("Установка расписания").text,
+    CP1251("Информация о WiFi").text,
+    CP1251("Калиб-ка температуры").text,
+    CP1251("Часовой пояс").text,
+    CP1251("Выход").text
   };
 
   void handleEncoder() {
+    encoder.update(); // Вычитываем события из буфера прерываний
     EncoderHandler::ButtonAction action = encoder.getButtonAction();
     int delta = encoder.getDelta();
+    if(action != EncoderHandler::NONE || delta != 0) {
+      invalidate();
+    }
 
     switch(currentState) {
 			case MAIN_SCREEN:
@@ -107,16 +165,12 @@ private:
 					visibleStartIndex = menuIndex;
 				}
 			  visibleStartIndex = constrain(visibleStartIndex, 0, 6 - visibleItemsCount);
-			  display.drawMenu(mainMenuItems + visibleStartIndex, visibleItemsCount, menuIndex - visibleStartIndex);
 			}
 			if(action == EncoderHandler::SHORT_PRESS) {
 				handleMenuSelection();
 			  }
 			if(action == EncoderHandler::LONG_PRESS) {
 			  currentState = MAIN_SCREEN;
-			  DateTime now = rtc.getNow();
-			  display.drawMainScreen(now, temp.getTemperature(), 
-									temp.isOverheated(), wifi.getState());
 			}
 			break;
 
@@ -130,23 +184,15 @@ private:
 			  
 			  if (action == EncoderHandler::LONG_PRESS) {
 				// Сохранение калибровки
-				temp.setCalibration(currentOffset);
+				temp.requestCalibration(currentOffset);
 				currentState = MAIN_SCREEN;
 			  }
 			  
 			  if (delta != 0) {
-				float step = delta * 0.5f;
+				TempCenti step = delta * degreesC(0, 50);
 				if (currentTempField == EDIT_OFFSET) { 
 				  currentOffset += step;
 				}
-				
-				// Явный вызов обновления дисплея
-				display.drawTemperatureCalibrationScreen(
-				  calibrationSource,
-				  calibrationSource + currentOffset,
-				  currentOffset,
-				  currentTempField
-				);
 			  }
 			  break;
 			
@@ -157,11 +203,8 @@ private:
 			}
 			if (action == EncoderHandler::LONG_PRESS) {
 			  // Сохраняем время и выходим из режима настройки
-			  rtc.setManualTime(editingTime);
+			  rtc.requestManualTime(editingTime);
 			  currentState = MAIN_SCREEN;
-			  DateTime now = rtc.getNow();
-			  display.drawMainScreen(now, temp.getTemperature(), 
-									temp.isOverheated(), wifi.getState());
 			}
 			if (delta != 0) {
 			  // Редактирование текущего поля
@@ -201,13 +244,11 @@ private:
 		case WIFI_INFO:
 		if(action == EncoderHandler::SHORT_PRESS) {
 			currentState = MAIN_MENU;
-			updateDisplay(); // Обновляем экран меню
 		}
 		if(action == EncoderHandler::LONG_PRESS) {
 			wifi.resetCredentials();
-			display.showDialog("WiFi сброшен!", 2000);
+			display.showDialog(CP1251("WiFi сброшен!"), 2000);
 			currentState = MAIN_SCREEN;
-			updateDisplay(); // Принудительное обновление главного экрана
 		}
 		break;
 
@@ -225,7 +266,7 @@ private:
 			if(action == EncoderHandler::SHORT_PRESS) {
 				editingTimezone = !editingTimezone;
 				if(!editingTimezone) {
-					rtc.setTimezoneOffset(timezoneOffset);
+					rtc.requestTimezoneOffset(timezoneOffset);
 				}
 			}
 			
@@ -252,13 +293,72 @@ private:
   }
 
   void updateDisplay() {
+    renderStats.frames++;
+    RenderInputs inputs = readInputs();
+    uint8_t changed = changedInputs(inputs, renderedInputs);
+    if(!redrawPending && currentState == renderedState &&
+       !(changed & dependenciesOf(currentState))) {
+      return; // Кадр не изменился - ни отрисовки, ни передачи по I2C
+    }
+    renderedInputs = inputs;
+    renderedState = currentState;
+    redrawPending = false;
+    renderStats.redraws++;
+    uint32_t heapBefore = HeapMonitor::sample();
+    drawScreen();
+    int32_t heapDelta = HeapMonitor::sample() - heapBefore;
+    if(heapDelta != 0) {
+      renderStats.heapFrames++;
+      if(heapDelta > 0) renderStats.heapCount += heapDelta;
+    }
+  }
+
+  static uint8_t dependenciesOf(State screen) {
+    switch(screen) {
+      case MAIN_SCREEN:     return DEP_SECONDS | DEP_TEMPERATURE | DEP_RELAY | DEP_WIFI;
+      case WIFI_INFO:
+      case AP_INFO:         return DEP_WIFI;
+      case RESET_ANIMATION: return DEP_ALWAYS;
+      default:              return 0; // Меню и настройки меняются только от энкодера
+    }
+  }
+
+  RenderInputs readInputs() const {
+    ControlSnapshot snapshot = state.read();
+    RenderInputs inputs;
+    inputs.epoch = rtc.nowEpoch();
+    inputs.temperature = roundTo(snapshot.temperature, 100);
+    inputs.slope = roundTo(snapshot.slope, 10);
+    inputs.predictedSeconds = snapshot.predictedMs < 0 ? -1 : snapshot.predictedMs / 1000;
+    inputs.overheated = snapshot.overheated;
+    inputs.relayOn = relay.getState();
+    inputs.blocked = relay.isBlocked();
+    inputs.wifiState = wifi.getState();
+    return inputs;
+  }
+
+  static uint8_t changedInputs(const RenderInputs& a, const RenderInputs& b) {
+    uint8_t changed = DEP_ALWAYS;
+    if(a.epoch != b.epoch) changed |= DEP_SECONDS;
+    if(a.temperature != b.temperature || a.slope != b.slope ||
+       a.predictedSeconds != b.predictedSeconds || a.overheated != b.overheated) {
+      changed |= DEP_TEMPERATURE;
+    }
+    if(a.relayOn != b.relayOn || a.blocked != b.blocked) changed |= DEP_RELAY;
+    if(a.wifiState != b.wifiState) changed |= DEP_WIFI;
+    return changed;
+  }
+
+  // Округление от нуля до шага, которым значение показывается на экране
+  static int32_t roundTo(int32_t value, int32_t step) {
+    return (value + (value < 0 ? -step / 2 : step / 2)) / step;
+  }
+
+  void drawScreen() {
     switch(currentState) {
-		case MAIN_SCREEN: {
-			DateTime now = rtc.getNow();
-			display.drawMainScreen(now, temp.getTemperature(), 
-								  temp.isOverheated(), wifi.getState());
+		case MAIN_SCREEN:
+			drawMainScreen();
 		break;
-		}
 		case MAIN_MENU:
 			display.drawMenu(mainMenuItems + visibleStartIndex, visibleItemsCount, menuIndex - visibleStartIndex);
 		break;
@@ -283,16 +383,16 @@ private:
 				wifiStateCache = wifi.getState();
 				ssidCache = wifi.getConnectedSSID();
 				ipCache = wifi.getIP();
-				display.drawWiFiInfoScreen(ssidCache, ipCache, wifiStateCache);
+				display.drawWiFiInfoScreen(ssidCache.c_str(), ipCache.c_str(), wifiStateCache);
 			}
 			break;
 		break;
 
 		case AP_INFO: 
 		display.drawAPInfoScreen(
-			wifi.getAPSSID(),
-								 wifi.getAPPassword(),
-								 wifi.getAPIP()
+			wifi.getAPSSID().c_str(),
+								 wifi.getAPPassword().c_str(),
+								 wifi.getAPIP().c_str()
 		);
 		break;
 
@@ -303,8 +403,9 @@ private:
       case SCHEDULE_SETUP:
 				display.drawScheduleSetupScreen(
 					currentDay,
-					startTime,
-					stopTime,
+					currentInterval,
+					slotStart[currentInterval],
+					slotStop[currentInterval],
 					acceleration,
 					currentScheduleField
 				);
@@ -317,6 +418,12 @@ private:
     }
   }
 
+  void drawMainScreen() {
+    ControlSnapshot snapshot = state.read();
+    display.drawMainScreen(rtc.getNow(), snapshot.temperature, snapshot.slope,
+                           snapshot.predictedMs, snapshot.overheated, wifi.getState());
+  }
+
   void drawResetAnimation() {
     float progress = (millis() - resetStartTime) / 20000.0;
     display.showResetAnimation(progress);
@@ -325,14 +432,18 @@ private:
   void handleMenuSelection() {
     switch(menuIndex) {
       case 0: currentState = TIME_SETUP; break;
-      case 1: currentState = SCHEDULE_SETUP; break;
+      case 1:
+	      currentState = SCHEDULE_SETUP;
+	      loadDaySchedule();
+	    break;
 	  case 2: // Пункт "Информация о WiFi"
 	  currentState = (wifi.getState() == WiFiManager::WiFiState::AP_MODE) ? AP_INFO : WIFI_INFO;
 	  break;
       case 3: // Калибровка температуры
 	      currentState = TEMP_CALIBRATION;
 	      currentOffset = temp.getCalibrationOffset();
-	      calibrationSource = temp.getRawTemperature() - currentOffset;
+	      // Калибруется основной датчик (первый на шине)
+	      calibrationSource = state.read().sensors[0].rawTemperature - currentOffset;
 	    break;
 			case 4: currentState = TIMEZONE_SETUP; break;
 			case 5: currentState = MAIN_SCREEN; break;
@@ -341,7 +452,7 @@ private:
 
   void handleScheduleSetup(int delta, EncoderHandler::ButtonAction action) {
 	  if (action == EncoderHandler::SHORT_PRESS) {
-	  	currentScheduleField = static_cast<ScheduleEditField>((currentScheduleField + 1) % 4);
+	  	currentScheduleField = static_cast<ScheduleEditField>((currentScheduleField + 1) % (SCHEDULE_EDIT_ACCELERATION + 1));
 	  }
   
 	  if (delta != 0) {
@@ -350,10 +461,8 @@ private:
   }
 
 	void handleScheduleValueChange(int delta) {
-		unsigned long now = millis();
-		if (now - lastEncoderMove > 300) acceleration = 0;
-		acceleration = constrain(acceleration + abs(delta), 1, 6);
-		lastEncoderMove = now;
+		// Ускорение по реальной скорости вращения (щелчков в секунду)
+		acceleration = constrain((int)(encoder.getVelocity() / 5), 1, 6);
 		
 		int multiplier = map(acceleration, 1, 6, 1, 30);
 		int step = delta * multiplier * 60; // Шаг в секундах
@@ -363,46 +472,60 @@ private:
 				currentDay = (currentDay + delta + 7) % 7;
 				loadDaySchedule();
 				break;
+
+			case SCHEDULE_EDIT_INTERVAL:
+				currentInterval = (currentInterval + delta % ScheduleManager::MAX_INTERVALS + ScheduleManager::MAX_INTERVALS) % ScheduleManager::MAX_INTERVALS;
+				break;
 				
 			case SCHEDULE_EDIT_START:
-				startTime = constrain(startTime + step, 0, 86399);
+				slotStart[currentInterval] = constrain((int32_t)slotStart[currentInterval] + step, 0, 86399);
 				break;
 				
 			case SCHEDULE_EDIT_STOP:
-				stopTime = constrain(stopTime + step, 0, 86399);
+				// 24:00 - до конца суток (с 00:00 - весь день)
+				slotStop[currentInterval] = constrain((int32_t)slotStop[currentInterval] + step, 0, (int32_t)ScheduleManager::SECONDS_PER_DAY);
+				break;
+
+			default:
 				break;
 		}
-		
-		DateTime currentTime = rtc.getNow();
-		schedule.forceScheduleCheck(currentTime);
 	}
 
 	void loadDaySchedule() {
 		// Добавляем проверку индекса дня
 		currentDay = constrain(currentDay, 0, 6);
-		startTime = schedule.weeklySchedule[currentDay].start;
-		stopTime = schedule.weeklySchedule[currentDay].end;
+		ScheduleManager::DaySchedule day = schedule.getDay(currentDay);
+		currentInterval = 0;
+		for(uint8_t i = 0; i < ScheduleManager::MAX_INTERVALS; i++) {
+			bool used = i < day.count;
+			slotStart[i] = used ? day.intervals[i].start : 0;
+			uint32_t end = used ? day.intervals[i].end : 0;
+			// Конец ровно в полночь остается 24:00, иначе 00:00-00:00 читался бы как пустой слот
+			slotStop[i] = (end > ScheduleManager::SECONDS_PER_DAY) ? end - ScheduleManager::SECONDS_PER_DAY : end;
+		}
 	}
 	
+	// Слоты сортируются и сливаются при сохранении
 	void saveDaySchedule() {
-		schedule.weeklySchedule[currentDay].start = startTime;
-		schedule.weeklySchedule[currentDay].end = stopTime;
+		ScheduleManager::DaySchedule day;
+		for(uint8_t i = 0; i < ScheduleManager::MAX_INTERVALS; i++) {
+			day.add(slotStart[i], slotStop[i]);
+		}
+		schedule.setDay(currentDay, day);
 		schedule.save();
-
-    DateTime now = rtc.getNow();
-	  schedule.forceScheduleCheck(now);
+		schedule.requestCheck();
 	}
 
   void resetWiFi() {
     wifi.resetCredentials();
-    display.showDialog("WiFi reset!", 2000);
+    display.showDialog(CP1251("WiFi reset!"), 2000);
     currentState = MAIN_SCREEN;
   }
 
   void performFactoryReset() {
     schedule.reset();
     wifi.resetCredentials();
-    temp.resetCalibration();
-    display.showDialog("Factory reset!", 3000);
+    temp.requestCalibrationReset();
+    display.showDialog(CP1251("Factory reset!"), 3000);
   }
 };
\ No newline at end of file
@@ -0,0 +1,232 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#include <SSD1306Wire.h>
+#include "Cp1251.h"
+#include "CompactFont.h"
+#include "I2CBus.h"
+#include <atomic>
+
+// SSD1306 с частичной передачей кадра. Хранит копию того, что уже на панели,
+// и перед передачей сравнивает с ней новый кадр постранично (8 страниц по 8 строк).
+// В каждой странице отправляются только измененные диапазоны столбцов:
+// окно задается командами COLUMNADDR/PAGEADDR, затем идут только его байты.
+// Обновление секунд на главном экране - десятки байт вместо 1 КБ,
+// шина I2C остается свободной для DS3231.
+//
+// После запуска runFlushLoop() в отдельной задаче display() не ждет шину:
+// готовый кадр копируется в буфер передачи, и задача отправляет его в фоне.
+// Если предыдущий кадр еще передается, новый откладывается и отправляется
+// через submitDeferred(), как только передача закончится (см. setFlushDoneCallback).
+//
+// Обмен идет через I2CBus: команды - PRIORITY_NORMAL, кадр - короткими
+// транзакциями PRIORITY_BULK, между которыми успевает чтение DS3231.
+//
+// Текст рисуется компактным шрифтом (setCompactFont) с распаковкой глифов
+// в буфер на стеке; выравнивание - только по левому краю.
+class PartialSSD1306 : public SSD1306Wire {
+public:
+  typedef void (*FlushDoneCallback)();
+
+  struct FlushStats {
+    uint32_t flushes = 0;   // Кадры, переданные на панель
+    uint32_t deferred = 0;  // Кадры, отложенные из-за идущей передачи
+    uint32_t windows = 0;   // Отправленные окна
+    uint32_t bytes = 0;     // Байты по I2C, включая команды
+    uint32_t maxFlushUs = 0;
+  };
+
+  PartialSSD1306(uint8_t address, int sda, int scl)
+    : SSD1306Wire(address, sda, scl, GEOMETRY_128_64, I2C_ONE, -1), // Частота - I2C_BUS_CLOCK (I2CBus)
+      address(address) {}
+
+  using SSD1306Wire::drawString;
+
+  // Шрифт из fontsCompact.h; nullptr - шрифт библиотеки (setFont)
+  void setCompactFont(const uint8_t* font) {
+    compactFont = font;
+  }
+
+  // Строка без String: библиотечный drawString копирует текст в кучу (strdup).
+  // UTF-8 декодируется через FontUtf8Rus - только для строк пользователя (SSID).
+  uint16_t drawString(int16_t x, int16_t y, const char* text) {
+    uint16_t length = strlen(text);
+    if(compactFont == nullptr) {
+      return drawStringInternal(x, y, text, length, getStringWidth(text, length, true), true);
+    }
+    char decoded[TEXT_CAPACITY];
+    uint8_t count = 0;
+    for(uint16_t i = 0; i < length && count < sizeof(decoded) - 1; i++) {
+      char c = fontTableLookupFunction ? fontTableLookupFunction((uint8_t)text[i]) : text[i];
+      if(c != 0) decoded[count++] = c;
+    }
+    decoded[count] = '\0';
+    return drawCompact(x, y, decoded);
+  }
+
+  // Текст, уже перекодированный в CP1251 (CP1251("...") или собранный из таких кусков)
+  uint16_t drawString(int16_t x, int16_t y, FontText text) {
+    if(compactFont != nullptr) {
+      return drawCompact(x, y, text.text);
+    }
+    uint16_t length = strlen(text.text);
+    return drawStringInternal(x, y, text.text, length, getStringWidth(text.text, length, false), false);
+  }
+
+  // Содержимое панели неизвестно (после init/сброса): следующий кадр - целиком
+  void invalidate() {
+    shadowValid = false;
+  }
+
+  // Вызывается после передачи кадра, если за это время был отложен новый.
+  // Выполняется в задаче передачи - только разбудить задачу UI.
+  void setFlushDoneCallback(FlushDoneCallback callback) {
+    flushDone = callback;
+  }
+
+  // Тело задачи передачи кадров, не возвращается
+  void runFlushLoop() {
+    flushTask.store(xTaskGetCurrentTaskHandle());
+    for(;;) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      sendFrame(frontBuffer);
+      busy.store(false);
+      if(deferred.load() && flushDone != nullptr) {
+        flushDone();
+      }
+    }
+  }
+
+  void display() override {
+    if(flushTask.load() == nullptr) {
+      sendFrame(buffer); // Задача передачи еще не запущена (init, ошибки при старте)
+      return;
+    }
+    if(busy.load()) {
+      if(!deferred.exchange(true)) stats.deferred++;
+      return;
+    }
+    memcpy(frontBuffer, buffer, FRAME_BYTES);
+    deferred.store(false);
+    busy.store(true);
+    xTaskNotifyGive(flushTask.load());
+  }
+
+  // Отправить отложенный кадр. Вызывается задачей UI, когда буфер
+  // отрисовки содержит законченный кадр (после отрисовки или вместо нее).
+  void submitDeferred() {
+    if(deferred.load() && !busy.load()) {
+      display();
+    }
+  }
+
+  const FlushStats& getFlushStats() const {
+    return stats;
+  }
+
+private:
+  static constexpr int16_t WIDTH = 128;
+  static constexpr uint8_t PAGES = 8;
+  static constexpr uint16_t FRAME_BYTES = WIDTH * PAGES;
+  static constexpr int16_t MERGE_GAP = 8;   // Столбцов: примерно цена заголовка окна
+  static constexpr uint8_t DATA_CHUNK = 32; // Байт данных на одну I2C-транзакцию
+
+  static constexpr uint8_t TEXT_CAPACITY = 64;
+
+  uint8_t address;
+  const uint8_t* compactFont = nullptr;
+  uint8_t shadow[FRAME_BYTES];      // То, что сейчас на панели
+  uint8_t frontBuffer[FRAME_BYTES]; // Кадр, который передается
+  bool shadowValid = false;
+  FlushStats stats;
+  std::atomic<TaskHandle_t> flushTask{nullptr};
+  std::atomic<bool> busy{false};
+  std::atomic<bool> deferred{false};
+  FlushDoneCallback flushDone = nullptr;
+
+  uint16_t drawCompact(int16_t x, int16_t y, const char* text) {
+    uint8_t height = CompactFont::height(compactFont);
+    uint8_t rasterHeight = 1 + ((height - 1) >> 3);
+    uint8_t glyphBytes[CompactFont::MAX_GLYPH_BYTES];
+    uint16_t drawn = 0;
+    for(const char* p = text; *p; p++) {
+      CompactFont::Glyph glyph;
+      if(!CompactFont::findGlyph(compactFont, (uint8_t)*p, glyph)) continue;
+      // Глифы за краем экрана не распаковываются
+      if(glyph.encodedBytes > 0 && x < WIDTH && x + glyph.width > 0) {
+        uint16_t size = glyph.width * rasterHeight;
+        if(size > sizeof(glyphBytes)) size = sizeof(glyphBytes);
+        CompactFont::decodeGlyph(glyph, height, glyphBytes, size);
+        drawFastImage(x, y, glyph.width, height, glyphBytes);
+      }
+      x += glyph.width;
+      drawn++;
+    }
+    return drawn;
+  }
+
+  void sendFrame(const uint8_t* frame) {
+    unsigned long startUs = micros();
+    for(uint8_t page = 0; page < PAGES; page++) {
+      const uint8_t* row = frame + page * WIDTH;
+      uint8_t* shadowRow = shadow + page * WIDTH;
+      int16_t start = -1;
+      int16_t last = -1;
+      for(int16_t x = 0; x < WIDTH; x++) {
+        if(shadowValid && row[x] == shadowRow[x]) continue;
+        if(start >= 0 && x - last > MERGE_GAP) {
+          // Разрыв длиннее заголовка окна - выгоднее отправить два окна
+          sendWindow(row, page, start, last);
+          start = -1;
+        }
+        if(start < 0) start = x;
+        last = x;
+      }
+      if(start >= 0) sendWindow(row, page, start, last);
+      memcpy(shadowRow, row, WIDTH);
+    }
+    shadowValid = true;
+    stats.flushes++;
+    uint32_t elapsed = micros() - startUs;
+    if(elapsed > stats.maxFlushUs) stats.maxFlushUs = elapsed;
+  }
+
+  // Команды библиотеки (инициализация, поворот экрана) - тоже через I2CBus
+  void sendCommand(uint8_t command) override {
+    I2CBus::Transaction bus(I2CBus::DEVICE_OLED, I2CBus::PRIORITY_NORMAL);
+    Wire.beginTransmission(address);
+    Wire.write(0x80);                 // Control: одна команда
+    Wire.write(command);
+    Wire.endTransmission();
+  }
+
+  void sendWindow(const uint8_t* row, uint8_t page, uint8_t firstColumn, uint8_t lastColumn) {
+    const uint8_t commands[] = {
+      0x21, firstColumn, lastColumn,  // COLUMNADDR
+      0x22, page, page                // PAGEADDR
+    };
+    {
+      I2CBus::Transaction bus(I2CBus::DEVICE_OLED, I2CBus::PRIORITY_BULK);
+      Wire.beginTransmission(address);
+      Wire.write(0x00);               // Control: поток команд
+      Wire.write(commands, sizeof(commands));
+      Wire.endTransmission();
+    }
+
+    const uint8_t* data = row + firstColumn;
+    uint16_t length = lastColumn - firstColumn + 1;
+    for(uint16_t offset = 0; offset < length; offset += DATA_CHUNK) {
+      uint16_t chunk = length - offset;
+      if(chunk > DATA_CHUNK) chunk = DATA_CHUNK;
+      // Шина отпускается после каждой порции - чтение часов не ждет весь кадр
+      I2CBus::Transaction bus(I2CBus::DEVICE_OLED, I2CBus::PRIORITY_BULK);
+      Wire.beginTransmission(address);
+      Wire.write(0x40);               // Control: поток данных
+      Wire.write(data + offset, chunk);
+      Wire.endTransmission();
+      stats.bytes += chunk + 1;
+    }
+    stats.windows++;
+    stats.bytes += sizeof(commands) + 1;
+  }
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include "Temperature.h"
 
 // GPIO Definitions
 #define TM1637_CLK      18
@@ -11,7 +12,71 @@
 #define I2C_SDA         21
 #define I2C_SCL         22
 
+// Общая шина DS3231 и SSD1306: Fast mode 400 кГц - предел DS3231 (и SSD1306 по спецификации)
+const uint32_t I2C_BUS_CLOCK = 400000;
+
 // Константы
-const float TEMP_HIGH_THRESHOLD = 75.0;
-const float TEMP_LOW_THRESHOLD = 50.0;
-const unsigned long SENSOR_UPDATE_INTERVAL = 1000;
\ No newline at end of file
+// Температуры - в сотых долях градуса (Temperature.h)
+constexpr TempCenti TEMP_HIGH_THRESHOLD = degreesC(75);
+constexpr TempCenti TEMP_LOW_THRESHOLD = degreesC(50);
+static_assert(TEMP_LOW_THRESHOLD < TEMP_HIGH_THRESHOLD, "hysteresis band is empty");
+const unsigned long SENSOR_UPDATE_INTERVAL = 1000;
+const uint8_t MAX_TEMP_SENSORS = 4; // DS18B20 на одной шине TEMP_PIN
+
+// Адаптивный опрос датчиков: далеко от порога - грубо и редко, рядом - точно и часто
+const unsigned long SENSOR_SLOW_INTERVAL = 5000; // 9 бит, 94 мс конвертации
+const unsigned long SENSOR_FAST_INTERVAL = 800;  // 12 бит, 750 мс конвертации
+constexpr TempCenti SENSOR_FAR_MARGIN = degreesC(15);      // До TEMP_HIGH_THRESHOLD
+constexpr TempCenti SENSOR_NEAR_MARGIN = degreesC(5);
+constexpr int32_t SENSOR_FAST_RISE = degreesC(2);          // Сотые °C в минуту
+constexpr int32_t SENSOR_SLOW_RISE = degreesC(0, 50);
+constexpr TempCenti SENSOR_MODE_HYSTERESIS = degreesC(1);
+
+// Упреждающее отключение: реле размыкается, если при текущей скорости роста
+// порог будет достигнут раньше чем через OVERHEAT_PREDICT_HORIZON (0 - выключено)
+const uint8_t SLOPE_WINDOW = 8;                        // Выборок в окне оценки наклона
+const uint32_t OVERHEAT_PREDICT_HORIZON = 30000;       // мс
+
+// История в ОЗУ (записей на ярус): 15 мин по секундам, сутки по минутам, неделя по часам
+const uint16_t HISTORY_SECONDS = 900;
+const uint16_t HISTORY_MINUTES = 1440;
+const uint16_t HISTORY_HOURS = 168;
+
+// Журнал во флеше (LittleFS)
+const uint16_t LOG_BLOCK_BYTES = 256;      // Сжатых данных в блоке (~100 минутных записей)
+const uint32_t LOG_BLOCK_SPAN = 3600;      // Блок пишется не реже раза в час, с
+const uint32_t LOG_SEGMENT_BYTES = 16384;  // Размер файла сегмента
+const uint32_t LOG_MAX_BYTES = 524288;     // Предел журнала: дальше ужатие старых сегментов
+const uint8_t LOG_MAX_SEGMENTS = 64;
+const int8_t ENCODER_TRANSITIONS_PER_DETENT = 4; // Переходов квадратуры на щелчок
+
+// Периоды задач планировщика (мс)
+const unsigned long DISPLAY_FRAME_INTERVAL = 200;
+const unsigned long TM1637_UPDATE_INTERVAL = 250;
+const unsigned long TM1637_STEP_INTERVAL = 1;     // Между порциями тактов TM1637
+const unsigned long SCHEDULE_AUDIT_INTERVAL = 60000;
+const unsigned long WEB_EVENT_TIMEOUT = 1000;     // Самое долгое ожидание событий веб-сервера
+const unsigned long RESTART_RESPONSE_TIMEOUT = 3000; // Ожидание отправки ответа перед перезагрузкой
+const unsigned long RESTART_CLOSE_DELAY = 100;    // На передачу хвоста закрытого сокета
+const unsigned long NTP_SYNC_INTERVAL = 3600000;
+const unsigned long NTP_RETRY_INTERVAL = 60000;
+const unsigned long NTP_POLL_INTERVAL = 10;
+const unsigned long RTC_RESYNC_INTERVAL = 600000;
+const unsigned long RTC_EDGE_LEAD = 50;           // Замер фронта DS3231 начинается раньше фронта часов
+const unsigned long RTC_EDGE_POLL_INTERVAL = 5;   // Между чтениями DS3231 при замере фронта
+const unsigned long RTC_EDGE_TIMEOUT = 1100;      // Фронт не найден - сверка откладывается
+const int32_t RTC_DRIFT_TOLERANCE_US = 20000;     // Меньшее расхождение - в пределах точности замера
+const unsigned long TASK_STATS_INTERVAL = 60000;
+const unsigned long HISTORY_SAMPLE_INTERVAL = 1000;
+const unsigned long LOG_POLL_INTERVAL = 60000;
+
+// Задачи FreeRTOS
+const uint32_t CONTROL_TASK_STACK = 4096;
+const uint32_t NETWORK_TASK_STACK = 8192;
+const uint32_t UI_TASK_STACK = 4096;
+const uint32_t OLED_TASK_STACK = 2048;
+const uint32_t WEB_EVENTS_TASK_STACK = 2048;
+const uint8_t CONTROL_TASK_PRIORITY = 5;
+const uint8_t NETWORK_TASK_PRIORITY = 3;
+const uint8_t UI_TASK_PRIORITY = 1;
+const uint8_t OLED_TASK_PRIORITY = 1;   // Передача кадров на OLED, ниже управления и сети
\ No newline at end of file
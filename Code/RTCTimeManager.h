@@ -2,68 +2,224 @@
 #include <WiFi.h>
 #include <RTClib.h>
 #include <WiFiUdp.h>
-#include <NTPClient.h>
 #include <Preferences.h>
+#include <esp_timer.h>
+#include <atomic>
 #include "Pins.h"
+#include "I2CBus.h"
+#include "SntpClient.h"
 #include "RelayController.h"
 #include "ScheduleManager.h"
 
 class RTCTimeManager {
 public:
 
-  RTCTimeManager() : 
-  timeClient(ntpUDP, "pool.ntp.org", 0, 60000) {} 
+  typedef void (*ClockChangeCallback)();
+
+  RTCTimeManager() : sntp(ntpUDP) {}
+
+  // Вызывается при каждом скачке программных часов (NTP, ручная установка, сверка с DS3231)
+  void setClockChangeCallback(ClockChangeCallback callback) {
+    clockChanged = callback;
+  }
 
 	void init() {
 		prefs.begin("time", true);
 		timezoneOffset = prefs.getInt("tz", 3);
 		prefs.end();
 		
-		if (!rtc.begin()) {
-			Serial.println("Couldn't find RTC");
-			while(1); // Остановка при отсутствии RTC
+		bool lostPower;
+		{
+			I2CBus::Transaction bus(I2CBus::DEVICE_RTC, I2CBus::PRIORITY_NORMAL);
+			if (!rtc.begin()) {
+				Serial.println("Couldn't find RTC");
+				while(1); // Остановка при отсутствии RTC
+			}
+			lostPower = rtc.lostPower();
 		}
 		
 		// Принудительное использование времени из DS3231
-		if(rtc.lostPower()) {
+		if(lostPower) {
 			Serial.println("RTC lost power, setting default time");
-			rtc.adjust(DateTime(F(__DATE__), F(__TIME__)));
+			writeRtc(DateTime(F(__DATE__), F(__TIME__)));
 		}
+		alignToRtcSecond();
 	}
 
-	void syncTime() {
-		if(WiFi.status() == WL_CONNECTED) {
-			timeClient.setTimeOffset(timezoneOffset * 3600);
-			if(timeClient.forceUpdate()) {
-				unsigned long epoch = timeClient.getEpochTime();
-				rtc.adjust(DateTime(epoch)); // Синхронизация только DS3231
-				needsSync = false;
+	// Сверка программных часов с DS3231: шаг задачи управления, возвращает мс до
+	// следующего вызова. Как и alignToRtcSecond(), ищет фронт секунды DS3231, но
+	// без ожидания: чтения идут через RTC_EDGE_POLL_INTERVAL, начиная незадолго до
+	// фронта программной секунды. Часы перепривязываются к найденному фронту, если
+	// расхождение больше RTC_DRIFT_TOLERANCE_US - меньшее в пределах точности замера.
+	unsigned long resync() {
+		if(!probing) {
+			probing = true;
+			probeGeneration = getClockGeneration();
+			probeLastSecond = 0;
+			uint32_t untilEdgeMs = (1000000 - nowEpochUs() % 1000000) / 1000;
+			return untilEdgeMs > RTC_EDGE_LEAD ? untilEdgeMs - RTC_EDGE_LEAD : untilEdgeMs + 1000 - RTC_EDGE_LEAD;
+		}
+
+		uint32_t second = readRtc().unixtime();
+		int64_t readUs = esp_timer_get_time();
+		if(getClockGeneration() != probeGeneration) {
+			probing = false; // Часы переставили во время замера - сверка в следующий раз
+			return RTC_RESYNC_INTERVAL;
+		}
+		if(probeLastSecond == 0) {
+			probeLastSecond = second;
+			probeLastUs = readUs;
+			probeStartMs = millis();
+			return RTC_EDGE_POLL_INTERVAL;
+		}
+		if(second == probeLastSecond) {
+			probeLastUs = readUs;
+			if(millis() - probeStartMs < RTC_EDGE_TIMEOUT) return RTC_EDGE_POLL_INTERVAL;
+			probing = false; // DS3231 не тикает - не сверяем
+			return RTC_RESYNC_INTERVAL;
+		}
+		probing = false;
+		resyncCount++;
+
+		// Фронт - между двумя последними чтениями
+		int64_t edgeUs = probeLastUs + (readUs - probeLastUs) / 2;
+		portENTER_CRITICAL(&clockLock);
+		if(clockGeneration != probeGeneration) {
+			portEXIT_CRITICAL(&clockLock);
+			return RTC_RESYNC_INTERVAL;
+		}
+		int64_t softUs = (int64_t)anchorEpoch * 1000000 + (edgeUs - anchorUs);
+		int64_t driftUs = (int64_t)second * 1000000 - softUs;
+		bool correct = driftUs >= RTC_DRIFT_TOLERANCE_US || driftUs <= -RTC_DRIFT_TOLERANCE_US;
+		if(correct) {
+			anchorEpoch = second;
+			anchorUs = edgeUs;
+			clockGeneration++;
+		}
+		portEXIT_CRITICAL(&clockLock);
+
+		if(correct) {
+			int32_t driftMs = (int32_t)(driftUs / 1000);
+			driftCorrections++;
+			totalDriftMs += abs(driftMs);
+			lastDriftMs = driftMs;
+			if(clockChanged) clockChanged();
+		}
+		return RTC_RESYNC_INTERVAL;
+	}
+
+	// Запросить внеочередную синхронизацию (например, после подключения к WiFi)
+	void requestSync() {
+		syncRequested = true;
+	}
+
+	// Шаг конечного автомата NTP: вызывается сетевой задачей каждые NTP_POLL_INTERVAL.
+	// Никогда не ждет ответа сервера - только отправляет запросы и читает сокет.
+	void pollSync() {
+		applySettingRequests();
+		writePendingRtc();
+		if(sntp.getState() == SntpClient::State::IDLE) {
+			if(shouldStartSync()) {
+				startSync();
 			}
+			return;
+		}
+
+		switch(sntp.poll(utcNowUs())) {
+			case SntpClient::State::DONE:
+				applySample(sntp.getBest());
+				sntp.reset();
+				break;
+			case SntpClient::State::FAILED:
+				syncFailures++;
+				sntp.reset();
+				break;
+			default:
+				break;
 		}
 	}
-  
-  void setTimezoneOffset(int offset) {
-		timezoneOffset = offset;
-		prefs.begin("time", false);
-		prefs.putInt("tz", offset);
-		prefs.end();
+	// Настройки из UI применяет сетевая задача в pollSync(): там же идет обмен NTP,
+	// и измерение, захватившее скачок часов, можно отбросить
+	void requestTimezoneOffset(int offset) {
+		portENTER_CRITICAL(&requestLock);
+		pendingTimezone = offset;
+		timezonePending = true;
+		portEXIT_CRITICAL(&requestLock);
 	}
 
   int getTimezoneOffset() const {
-		return timezoneOffset;
+		return timezoneOffset.load();
 	}
 
-  DateTime getNow() {
-    return rtc.now();
+  // Время из программных часов: без обращения к шине I2C
+  DateTime getNow() const {
+    return DateTime(nowEpoch());
+  }
+
+  uint32_t nowEpoch() const {
+    portENTER_CRITICAL(&clockLock);
+    uint32_t epoch = anchorEpoch;
+    int64_t anchor = anchorUs;
+    portEXIT_CRITICAL(&clockLock);
+    return epoch + (uint32_t)((esp_timer_get_time() - anchor) / 1000000);
+  }
+
+  uint64_t nowEpochUs() const {
+    portENTER_CRITICAL(&clockLock);
+    uint32_t epoch = anchorEpoch;
+    int64_t anchor = anchorUs;
+    portEXIT_CRITICAL(&clockLock);
+    return (uint64_t)epoch * 1000000 + (esp_timer_get_time() - anchor);
+  }
+
+  int64_t getLastNtpOffsetUs() const {
+    return lastOffsetUs;
+  }
+
+  uint32_t getLastNtpRttUs() const {
+    return lastRttUs;
+  }
+
+  const char* getLastNtpServer() const {
+    return lastServer;
+  }
+
+  // Возраст последней успешной синхронизации в секундах, UINT32_MAX - не было
+  uint32_t getSyncAge() const {
+    if(lastSyncMs == 0) return UINT32_MAX;
+    return (millis() - lastSyncMs) / 1000;
+  }
+
+  uint32_t getSyncFailures() const {
+    return syncFailures;
+  }
+
+  uint32_t getResyncCount() const {
+    return resyncCount;
+  }
+
+  uint32_t getDriftCorrections() const {
+    return driftCorrections;
+  }
+
+  // Расхождения с DS3231 в мс (только исправленные)
+  int32_t getLastDrift() const {
+    return lastDriftMs;
+  }
+
+  uint32_t getTotalDrift() const {
+    return totalDriftMs;
   }
 
   bool needsTimeSync() const {
     return needsSync;
   }
 
-  void setManualTime(const DateTime& dt) {
-    rtc.adjust(dt);
-    needsSync = false;
+  void requestManualTime(const DateTime& dt) {
+    portENTER_CRITICAL(&requestLock);
+    pendingManualEpoch = dt.unixtime();
+    manualTimePending = true;
+    portEXIT_CRITICAL(&requestLock);
   }
 
 	String formatDateTime(const DateTime& dt) {
@@ -76,10 +232,205 @@ public:
 	}
 
 private:
+  static constexpr uint8_t NTP_SERVER_COUNT = 3;
+  static const char* const NTP_SERVERS[NTP_SERVER_COUNT];
+
   RTC_DS3231 rtc;
   WiFiUDP ntpUDP;
-  NTPClient timeClient;
+  SntpClient sntp;
   bool needsSync = true;
-  int timezoneOffset = 3;
+  bool syncRequested = false;
+  unsigned long lastSyncMs = 0;
+  unsigned long lastAttemptMs = 0;
+  uint32_t syncFailures = 0;
+  int64_t lastOffsetUs = 0;
+  uint32_t lastRttUs = 0;
+  const char* lastServer = "-";
+  std::atomic<int> timezoneOffset{3};
 	Preferences prefs;
+
+	// Запросы из UI, см. applySettingRequests()
+	portMUX_TYPE requestLock = portMUX_INITIALIZER_UNLOCKED;
+	bool manualTimePending = false;
+	uint32_t pendingManualEpoch = 0;
+	bool timezonePending = false;
+	int pendingTimezone = 0;
+
+	// Программные часы: эпоха DS3231 + время esp_timer с момента привязки
+	mutable portMUX_TYPE clockLock = portMUX_INITIALIZER_UNLOCKED;
+	uint32_t anchorEpoch = 0;
+	int64_t anchorUs = 0;
+	uint32_t resyncCount = 0;
+	uint32_t driftCorrections = 0;
+	uint32_t totalDriftMs = 0;
+	int32_t lastDriftMs = 0;
+	ClockChangeCallback clockChanged = nullptr;
+	// Меняется при каждой перепривязке часов и записи DS3231: замер фронта в
+	// resync(), захвативший такое изменение, отбрасывается
+	uint32_t clockGeneration = 0;
+
+	// Замер фронта секунды DS3231 (resync)
+	bool probing = false;
+	uint32_t probeGeneration = 0;
+	uint32_t probeLastSecond = 0;
+	int64_t probeLastUs = 0;
+	unsigned long probeStartMs = 0;
+
+	// Запись в DS3231 после NTP ждет фронта секунды (writePendingRtc)
+	bool rtcWritePending = false;
+
+	uint32_t getClockGeneration() const {
+		portENTER_CRITICAL(&clockLock);
+		uint32_t generation = clockGeneration;
+		portEXIT_CRITICAL(&clockLock);
+		return generation;
+	}
+
+	void setAnchor(uint32_t epoch) {
+		portENTER_CRITICAL(&clockLock);
+		anchorEpoch = epoch;
+		anchorUs = esp_timer_get_time();
+		clockGeneration++;
+		portEXIT_CRITICAL(&clockLock);
+		if(clockChanged) clockChanged();
+	}
+
+	// Привязка с точностью до микросекунды (после NTP)
+	void setAnchorUs(uint64_t epochUs) {
+		portENTER_CRITICAL(&clockLock);
+		anchorEpoch = epochUs / 1000000;
+		anchorUs = esp_timer_get_time() - (int64_t)(epochUs % 1000000);
+		clockGeneration++;
+		portEXIT_CRITICAL(&clockLock);
+		if(clockChanged) clockChanged();
+	}
+
+	void applySettingRequests() {
+		portENTER_CRITICAL(&requestLock);
+		bool manualTime = manualTimePending;
+		uint32_t manualEpoch = pendingManualEpoch;
+		bool timezone = timezonePending;
+		int offset = pendingTimezone;
+		manualTimePending = false;
+		timezonePending = false;
+		portEXIT_CRITICAL(&requestLock);
+		if(!manualTime && !timezone) return;
+
+		// Отметки времени текущего обмена NTP сняты по прежним часам
+		if(sntp.getState() != SntpClient::State::IDLE) sntp.reset();
+		if(timezone) {
+			int previous = timezoneOffset.exchange(offset);
+			prefs.begin("time", false);
+			prefs.putInt("tz", offset);
+			prefs.end();
+			// Часы и DS3231 идут по местному времени: UTC остается прежним, местное
+			// сдвигается сразу (расписание перевзводится через clockChanged), NTP
+			// подтверждает его внеочередной синхронизацией
+			if(offset != previous && !manualTime) {
+				setAnchorUs(nowEpochUs() + (int64_t)(offset - previous) * 3600 * 1000000);
+				rtcWritePending = true;
+				syncRequested = true;
+			}
+		}
+		if(manualTime) {
+			rtcWritePending = false; // Ручное время важнее еще не записанного NTP
+			writeRtc(DateTime(manualEpoch));
+			setAnchor(manualEpoch);
+			needsSync = false;
+		}
+	}
+
+	// DS3231 хранит местное время, NTP работает в UTC
+	uint64_t utcNowUs() const {
+		return nowEpochUs() - (int64_t)timezoneOffset * 3600 * 1000000;
+	}
+
+	bool shouldStartSync() {
+		if(WiFi.status() != WL_CONNECTED) return false;
+		if(syncRequested) return true;
+		if(lastSyncMs != 0 && millis() - lastSyncMs < NTP_SYNC_INTERVAL) return false;
+		// Повтор после неудачи не чаще NTP_RETRY_INTERVAL
+		return lastAttemptMs == 0 || millis() - lastAttemptMs >= NTP_RETRY_INTERVAL;
+	}
+
+	void startSync() {
+		syncRequested = false;
+		lastAttemptMs = millis();
+		// DNS-запросы блокируют только сетевую задачу
+		for(uint8_t i = 0; i < NTP_SERVER_COUNT; i++) {
+			IPAddress address;
+			if(WiFi.hostByName(NTP_SERVERS[i], address) != 1) {
+				address = IPAddress(0, 0, 0, 0);
+			}
+			sntp.setServer(i, address);
+		}
+		if(!sntp.start(utcNowUs())) {
+			syncFailures++;
+			sntp.reset();
+		}
+	}
+
+	void applySample(const SntpClient::Sample& sample) {
+		uint64_t corrected = nowEpochUs() + sample.offsetUs;
+		setAnchorUs(corrected);
+		rtcWritePending = true; // DS3231 - на ближайшем фронте секунды
+		writePendingRtc();
+		lastOffsetUs = sample.offsetUs;
+		lastRttUs = sample.rttUs;
+		lastServer = NTP_SERVERS[sample.server];
+		lastSyncMs = millis();
+		needsSync = false;
+	}
+
+	// Обмен с DS3231 - только через I2CBus: чтение времени идет вне очереди кадров OLED
+	DateTime readRtc() {
+		I2CBus::Transaction bus(I2CBus::DEVICE_RTC, I2CBus::PRIORITY_URGENT);
+		return rtc.now();
+	}
+
+	void writeRtc(const DateTime& dt) {
+		portENTER_CRITICAL(&clockLock);
+		clockGeneration++;
+		portEXIT_CRITICAL(&clockLock);
+		I2CBus::Transaction bus(I2CBus::DEVICE_RTC, I2CBus::PRIORITY_NORMAL);
+		rtc.adjust(dt);
+	}
+
+	// DS3231 начинает отсчет секунды заново при записи, а хранит только целые
+	// секунды. Запись ровно на фронте программной секунды сохраняет фазу NTP,
+	// иначе DS3231 отставал бы на дробную часть (до 1 с). Фронт ждется опросами
+	// pollSync(); последний отрезок, который следующий опрос уже проскочил бы, -
+	// короткой задержкой.
+	void writePendingRtc() {
+		if(!rtcWritePending) return;
+		uint32_t untilEdgeUs = 1000000 - nowEpochUs() % 1000000;
+		if(untilEdgeUs > 2 * NTP_POLL_INTERVAL * 1000) return;
+		delayMicroseconds(untilEdgeUs);
+		rtcWritePending = false;
+		I2CBus::Transaction bus(I2CBus::DEVICE_RTC, I2CBus::PRIORITY_URGENT);
+		portENTER_CRITICAL(&clockLock);
+		clockGeneration++;
+		portEXIT_CRITICAL(&clockLock);
+		// Секунда - по часам после захвата шины (только что начавшаяся)
+		rtc.adjust(DateTime(nowEpoch()));
+	}
+
+	// Привязка к фронту секунды DS3231, чтобы дробная часть не давала ошибку до 1 с.
+	// Выполняется один раз при старте.
+	void alignToRtcSecond() {
+		uint32_t start = readRtc().unixtime();
+		unsigned long deadline = millis() + 1100;
+		uint32_t current = start;
+		while(current == start && (long)(millis() - deadline) < 0) {
+			delay(5);
+			current = readRtc().unixtime();
+		}
+		setAnchor(current);
+	}
+};
+
+const char* const RTCTimeManager::NTP_SERVERS[] = {
+	"pool.ntp.org",
+	"time.google.com",
+	"time.cloudflare.com"
 };
\ No newline at end of file
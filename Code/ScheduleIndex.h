@@ -0,0 +1,69 @@
+#pragma once
+#include <Arduino.h>
+
+// Скомпилированное расписание: по биту на каждую минуту недели (10080 бит, 1260 байт).
+// Минута 0 - понедельник 00:00. Текущее состояние - проверка одного бита,
+// ближайший фронт - поиск по словам через count-trailing-zeros.
+class WeekBitmap {
+public:
+  static constexpr uint16_t MINUTES_PER_DAY = 1440;
+  static constexpr uint16_t MINUTES_PER_WEEK = 7 * MINUTES_PER_DAY;
+  static constexpr uint16_t WORDS = MINUTES_PER_WEEK / 32;
+
+  static_assert(MINUTES_PER_WEEK % 32 == 0, "week must fill whole words");
+
+  void clear() {
+    memset(words, 0, sizeof(words));
+  }
+
+  // Включает минуты [from, to) с переходом через конец недели
+  void setRange(uint16_t from, uint16_t to) {
+    from %= MINUTES_PER_WEEK;
+    to %= MINUTES_PER_WEEK;
+    if(from == to) return;
+    if(from < to) {
+      fill(from, to);
+    } else {
+      fill(from, MINUTES_PER_WEEK);
+      fill(0, to);
+    }
+  }
+
+  bool test(uint16_t minute) const {
+    return (words[minute / 32] >> (minute % 32)) & 1;
+  }
+
+  // Через сколько минут (1..10080) после minute встретится минута со значением value.
+  // -1 - такой минуты в неделе нет.
+  int32_t distanceTo(uint16_t minute, bool value) const {
+    uint16_t start = (minute + 1) % MINUTES_PER_WEEK;
+    uint16_t word = start / 32;
+    uint32_t mask = 0xFFFFFFFFu << (start % 32);
+
+    // WORDS + 1 итераций: последняя возвращается к младшим битам первого слова
+    for(uint16_t i = 0; i <= WORDS; i++) {
+      uint32_t bits = (value ? words[word] : ~words[word]) & mask;
+      if(bits != 0) {
+        uint16_t index = word * 32 + __builtin_ctz(bits);
+        uint16_t distance = (index + MINUTES_PER_WEEK - minute) % MINUTES_PER_WEEK;
+        return distance == 0 ? MINUTES_PER_WEEK : distance;
+      }
+      mask = 0xFFFFFFFFu;
+      word = (word + 1) % WORDS;
+    }
+    return -1;
+  }
+
+private:
+  uint32_t words[WORDS] = {0};
+
+  void fill(uint16_t from, uint16_t to) {
+    while(from < to) {
+      uint16_t bit = from % 32;
+      uint16_t count = (to - from < 32 - bit) ? to - from : 32 - bit;
+      uint32_t mask = (count == 32) ? 0xFFFFFFFFu : (((1u << count) - 1) << bit);
+      words[from / 32] |= mask;
+      from += count;
+    }
+  }
+};
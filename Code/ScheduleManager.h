@@ -1,48 +1,213 @@
 #pragma once
 #include <Preferences.h>
 #include <RTClib.h>
+#include <esp_timer.h>
 #include "RelayController.h"
+#include "ScheduleIndex.h"
 
 class ScheduleManager {
 public:
-  struct Schedule {
+  static constexpr uint8_t MAX_INTERVALS = 4;
+  static constexpr uint32_t SECONDS_PER_DAY = 86400;
+
+  // Интервал в секундах от начала дня. end > SECONDS_PER_DAY -
+  // интервал продолжается в следующие сутки.
+  struct Interval {
     uint32_t start;
     uint32_t end;
   };
 
-  ScheduleManager(RelayController& relay) : relay(relay) {}
+  // Отсортированный список непересекающихся интервалов дня фиксированной емкости
+  struct DaySchedule {
+    Interval intervals[MAX_INTERVALS];
+    uint8_t count = 0;
+
+    void clear() {
+      count = 0;
+    }
+
+    // Добавляет интервал с сортировкой и слиянием пересечений.
+    // start == end - пустой интервал (игнорируется), end - start == SECONDS_PER_DAY
+    // (например, 0..SECONDS_PER_DAY) - весь день. false - нет места.
+    bool add(uint32_t start, uint32_t end) {
+      if(start >= SECONDS_PER_DAY || end > 2 * SECONDS_PER_DAY) return false;
+      if(start == end) return true;
+      if(end < start) end += SECONDS_PER_DAY; // Через полночь
+      if(end > start + SECONDS_PER_DAY) return false;
+
+      Interval sorted[MAX_INTERVALS + 1];
+      uint8_t n = 0;
+      uint8_t i = 0;
+      while(i < count && intervals[i].start <= start) sorted[n++] = intervals[i++];
+      sorted[n++] = {start, end};
+      while(i < count) sorted[n++] = intervals[i++];
+
+      uint8_t merged = 0;
+      for(uint8_t k = 0; k < n; k++) {
+        if(merged > 0 && sorted[k].start <= sorted[merged - 1].end) {
+          if(sorted[k].end > sorted[merged - 1].end) {
+            sorted[merged - 1].end = sorted[k].end;
+          }
+        } else {
+          sorted[merged++] = sorted[k];
+        }
+      }
+      if(merged > MAX_INTERVALS) return false;
+      memcpy(intervals, sorted, merged * sizeof(Interval));
+      count = merged;
+      return true;
+    }
+  };
+
+  typedef void (*WakeCallback)();
+
+  // Фронт считается опоздавшим, если реле переключилось позже этого срока
+  static constexpr uint64_t EDGE_LATE_US = 1000;
+
+  struct EdgeStats {
+    uint32_t fired = 0;
+    uint32_t late = 0;   // Переключение позже EDGE_LATE_US
+    uint32_t missed = 0; // Аудит нашел реле не в том состоянии
+    uint32_t maxLatenessUs = 0;
+  };
+
+  ScheduleManager(RelayController& relay) : relay(relay), prefsLock(xSemaphoreCreateMutex()) {}
+
+  // onWake будит задачу управления (из таймера фронта или после изменений)
+  void begin(WakeCallback onWake) {
+    wakeCallback = onWake;
+    esp_timer_create_args_t args = {};
+    args.callback = onEdgeTimer;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "sched_edge";
+    esp_timer_create(&args, &edgeTimer);
+  }
 
 	void load() {
+		bool legacyFound = false;
+		xSemaphoreTake(prefsLock, portMAX_DELAY);
 		prefs.begin("schedule", true);
 		for(int i = 0; i < 7; i++) {
-			uint32_t start = prefs.getUInt(getKey(i, true).c_str(), 0);
-			uint32_t end = prefs.getUInt(getKey(i, false).c_str(), 0);
-			// Валидация данных
-			weeklySchedule[i].start = (start <= 86400) ? start : 0;
-			weeklySchedule[i].end = (end <= 86400) ? end : 0;
+			DaySchedule day;
+			StoredDay stored;
+			if(prefs.getBytes(getDayKey(i).c_str(), &stored, sizeof(stored)) == sizeof(stored) &&
+			   stored.version == STORAGE_VERSION) {
+				for(uint8_t j = 0; j < stored.count && j < MAX_INTERVALS; j++) {
+					day.add(stored.intervals[j].start, stored.intervals[j].end);
+				}
+			} else {
+				// Старый формат: одна пара d<N>s/d<N>e на день
+				legacyFound |= prefs.isKey(getKey(i, true).c_str());
+				uint32_t start = prefs.getUInt(getKey(i, true).c_str(), 0);
+				uint32_t end = prefs.getUInt(getKey(i, false).c_str(), 0);
+				// Валидация данных
+				day.add((start <= 86400) ? start : 0, (end <= 86400) ? end : 0);
+			}
+			setDay(i, day);
 		}
 		prefs.end();
+		xSemaphoreGive(prefsLock);
+		if(legacyFound) save(); // Перевод в w<N>, старые ключи удаляются
 	}
 
+  // Сохраняют и меню (UI), и веб (сетевая задача): NVS - под prefsLock
   void save() {
+    xSemaphoreTake(prefsLock, portMAX_DELAY);
     prefs.begin("schedule", false);
     for(int i = 0; i < 7; i++) {
-      prefs.putUInt(getKey(i, true).c_str(), weeklySchedule[i].start);
-      prefs.putUInt(getKey(i, false).c_str(), weeklySchedule[i].end);
+      DaySchedule day = getDay(i);
+      StoredDay stored;
+      stored.version = STORAGE_VERSION;
+      stored.count = day.count;
+      memcpy(stored.intervals, day.intervals, day.count * sizeof(Interval));
+      prefs.putBytes(getDayKey(i).c_str(), &stored, sizeof(stored));
+      // Рядом с w<N> старые d<N>s/d<N>e не нужны
+      for(uint8_t k = 0; k < 2; k++) {
+        String key = getKey(i, k == 0);
+        if(prefs.isKey(key.c_str())) prefs.remove(key.c_str());
+      }
     }
     prefs.end();
+    xSemaphoreGive(prefsLock);
   }
 
   void reset() {
+    xSemaphoreTake(prefsLock, portMAX_DELAY);
     prefs.begin("schedule", false);
     prefs.clear();
     prefs.end();
+    xSemaphoreGive(prefsLock);
     load(); // Загрузить пустые значения
   }
 
-	void forceScheduleCheck(const DateTime& now) {
-		bool newState = checkSchedule(now);
-		updateRelayState(newState);
+	// Реле переключает только задача управления: UI и веб лишь
+	// будят ее после изменения расписания
+	void requestCheck() {
+		if(wakeCallback) wakeCallback();
+	}
+
+	// Оценка расписания и взвод таймера на следующий фронт.
+	// Вызывается задачей управления при срабатывании таймера и при любом
+	// изменении расписания, часов или блокировки реле.
+	bool update(uint64_t nowEpochUs) {
+		if(armedEdgeUs != 0 && nowEpochUs >= armedEdgeUs) {
+			uint64_t lateness = nowEpochUs - armedEdgeUs;
+			edgeStats.fired++;
+			if(lateness > EDGE_LATE_US) edgeStats.late++;
+			if(lateness > edgeStats.maxLatenessUs) edgeStats.maxLatenessUs = lateness;
+			armedEdgeUs = 0;
+		}
+
+		DateTime now((uint32_t)(nowEpochUs / 1000000));
+		bool state = checkSchedule(now);
+		armNextEdge(now, nowEpochUs);
+		return state;
+	}
+
+	// Контроль: реле не в том состоянии, что требует расписание - фронт пропущен
+	void audit(uint64_t nowEpochUs) {
+		DateTime now((uint32_t)(nowEpochUs / 1000000));
+		if(!relay.isBlocked() && relay.getState() != isActiveNow(now)) {
+			edgeStats.missed++;
+		}
+		update(nowEpochUs);
+	}
+
+	const EdgeStats& getEdgeStats() const {
+		return edgeStats;
+	}
+
+	// Ближайшее изменение состояния расписания
+	bool getNextEdge(const DateTime& now, DateTime& edge) const {
+		uint16_t minute = minuteOfWeek(now);
+		portENTER_CRITICAL(&scheduleLock);
+		int32_t distance = weekIndex.distanceTo(minute, !weekIndex.test(minute));
+		portEXIT_CRITICAL(&scheduleLock);
+		if(distance < 0) return false; // Расписание постоянно
+		edge = minuteStart(now) + TimeSpan(distance * 60);
+		return true;
+	}
+
+	DaySchedule getDay(uint8_t day) const {
+		portENTER_CRITICAL(&scheduleLock);
+		DaySchedule copy = weeklySchedule[day % 7];
+		portEXIT_CRITICAL(&scheduleLock);
+		return copy;
+	}
+
+	void setDay(uint8_t day, const DaySchedule& schedule) {
+		portENTER_CRITICAL(&scheduleLock);
+		weeklySchedule[day % 7] = schedule;
+		rebuildIndex();
+		portEXIT_CRITICAL(&scheduleLock);
+	}
+
+	// Один интервал на день (прежний формат)
+	void setDay(uint8_t day, uint32_t start, uint32_t end) {
+		DaySchedule schedule;
+		schedule.add(start, end);
+		setDay(day, schedule);
 	}
 
 	void updateRelayState(bool newState) const {
@@ -52,76 +217,132 @@ public:
 	}
 
 	bool checkSchedule(const DateTime& now) const {
-		if(relay.isBlocked()) return false;
-		
-		// Корректировка дня недели согласно DS3231 (0=воскресенье -> 0=понедельник)
-		uint8_t currentDay = (now.dayOfTheWeek() + 6) % 7; // Преобразование к 0=ПН, 6=ВС
-		uint32_t currentTime = now.hour() * 3600 + now.minute() * 60 + now.second();
-		Schedule daySchedule = weeklySchedule[currentDay];
-		
-		bool newState = false;
-		
-		if(daySchedule.start == daySchedule.end) {
-			newState = false; // Расписание отключено
-		}
-		else if(daySchedule.start < daySchedule.end) {
-			newState = (currentTime >= daySchedule.start && currentTime < daySchedule.end);
-		} 
-		else {
-			newState = (currentTime >= daySchedule.start || currentTime < daySchedule.end);
-		}
-		
+		bool newState = isActiveNow(now);
 		updateRelayState(newState);
 		return newState;
 	}
 
-	DateTime getNextStartTime(const DateTime& now) {
-		uint8_t currentDay = (now.dayOfTheWeek() + 6) % 7; // Корректировка дня
-		uint32_t currentTime = now.hour() * 3600 + now.minute() * 60 + now.second();
+	// Чистая оценка расписания без переключения реле: проверка одного бита
+	bool isActiveNow(const DateTime& now) const {
+		if(relay.isBlocked()) return false;
 		
-		for(int i = 0; i < 7; i++) {
-			uint8_t day = (currentDay + i) % 7;
-			uint32_t targetTime = weeklySchedule[day].start;
-			
-			if((i == 0 && targetTime > currentTime) || i > 0) {
-				return now + TimeSpan((i * 86400) + (targetTime - currentTime));
+		portENTER_CRITICAL(&scheduleLock);
+		bool active = weekIndex.test(minuteOfWeek(now));
+		portEXIT_CRITICAL(&scheduleLock);
+		return active;
+	}
+
+	DateTime getNextStartTime(const DateTime& now) const {
+		uint16_t minute = minuteOfWeek(now);
+		portENTER_CRITICAL(&scheduleLock);
+		int32_t distance = -1;
+		if(weekIndex.test(minute)) {
+			// Сейчас включено - ищем начало следующего интервала
+			int32_t off = weekIndex.distanceTo(minute, false);
+			if(off > 0) {
+				int32_t on = weekIndex.distanceTo((minute + off) % WeekBitmap::MINUTES_PER_WEEK, true);
+				distance = (on > 0) ? off + on : -1;
 			}
+		} else {
+			distance = weekIndex.distanceTo(minute, true);
+		}
+		portEXIT_CRITICAL(&scheduleLock);
+
+		if(distance < 0) {
+			return now + TimeSpan(86400); // Fallback: следующее расписание через 24ч
 		}
-		return now + TimeSpan(86400); // Fallback: следующее расписание через 24ч
+		return minuteStart(now) + TimeSpan(distance * 60);
 	}
 
-	DateTime getNextShutdownTime(const DateTime& now) {
-		uint8_t currentDay = (now.dayOfTheWeek() + 6) % 7; // Исправлено приведение дня недели
-		uint32_t currentTime = now.hour() * 3600 + now.minute() * 60 + now.second();
-	
-		for(int i = 0; i < 7; i++) {
-			uint8_t day = (currentDay + i) % 7;
-			uint32_t endTime = weeklySchedule[day].end;
-	
-			// Если время окончания сегодня и еще не наступило
-			if(i == 0 && endTime > currentTime) {
-				return DateTime(now.year(), now.month(), now.day()) + TimeSpan(endTime);
-			}
-			// Если сегодняшнее время окончания прошло, ищем следующий день
-			else if(i > 0 && weeklySchedule[day].end != weeklySchedule[day].start) {
-				DateTime nextDay = now + TimeSpan(i, 0, 0, 0);
-				return DateTime(nextDay.year(), nextDay.month(), nextDay.day()) + TimeSpan(weeklySchedule[day].end);
+	DateTime getNextShutdownTime(const DateTime& now) const {
+		uint16_t minute = minuteOfWeek(now);
+		portENTER_CRITICAL(&scheduleLock);
+		int32_t distance = -1;
+		if(weekIndex.test(minute)) {
+			distance = weekIndex.distanceTo(minute, false);
+		} else {
+			// Сейчас выключено - конец ближайшего будущего интервала
+			int32_t on = weekIndex.distanceTo(minute, true);
+			if(on > 0) {
+				int32_t off = weekIndex.distanceTo((minute + on) % WeekBitmap::MINUTES_PER_WEEK, false);
+				distance = (off > 0) ? on + off : -1;
 			}
 		}
-		return now; // Fallback
-	}
+		portEXIT_CRITICAL(&scheduleLock);
 
-	bool isActiveNow(const DateTime& now) const {
-		return checkSchedule(now);
+		if(distance < 0) {
+			return now; // Fallback
+		}
+		return minuteStart(now) + TimeSpan(distance * 60);
 	}
 
-  Schedule weeklySchedule[7];
-
 private:
+  static constexpr uint8_t STORAGE_VERSION = 2;
+
+  // Формат хранения дня в Preferences (ключ w<N>)
+  struct StoredDay {
+    uint8_t version = 0;
+    uint8_t count = 0;
+    Interval intervals[MAX_INTERVALS] = {};
+  };
+
+  DaySchedule weeklySchedule[7];
   RelayController& relay;
   Preferences prefs;
+  SemaphoreHandle_t prefsLock;
+  mutable portMUX_TYPE scheduleLock = portMUX_INITIALIZER_UNLOCKED;
+  WakeCallback wakeCallback = nullptr;
+  esp_timer_handle_t edgeTimer = nullptr;
+  uint64_t armedEdgeUs = 0;
+  EdgeStats edgeStats;
+  WeekBitmap weekIndex; // Пересобирается только при изменении weeklySchedule
+
+  // Вызывается под scheduleLock. Интервал через полночь продолжается
+  // в следующий день (воскресенье переходит в понедельник).
+  void rebuildIndex() {
+    weekIndex.clear();
+    for(uint16_t day = 0; day < 7; day++) {
+      uint16_t dayBase = day * WeekBitmap::MINUTES_PER_DAY;
+      const DaySchedule& schedule = weeklySchedule[day];
+      for(uint8_t i = 0; i < schedule.count; i++) {
+        // end за пределами суток переходит в следующий день (с переходом недели)
+        weekIndex.setRange(dayBase + schedule.intervals[i].start / 60,
+                           dayBase + schedule.intervals[i].end / 60);
+      }
+    }
+  }
+
+  // Минута недели, 0 = понедельник 00:00 (DS3231: 0 = воскресенье)
+  static uint16_t minuteOfWeek(const DateTime& now) {
+    uint8_t day = (now.dayOfTheWeek() + 6) % 7;
+    return day * WeekBitmap::MINUTES_PER_DAY + now.hour() * 60 + now.minute();
+  }
+
+  static DateTime minuteStart(const DateTime& now) {
+    return now - TimeSpan(now.second());
+  }
+
+  void armNextEdge(const DateTime& now, uint64_t nowEpochUs) {
+    if(edgeTimer == nullptr) return;
+    esp_timer_stop(edgeTimer);
+    armedEdgeUs = 0;
+
+    DateTime edge;
+    if(!getNextEdge(now, edge)) return;
+    armedEdgeUs = (uint64_t)edge.unixtime() * 1000000;
+    esp_timer_start_once(edgeTimer, armedEdgeUs - nowEpochUs);
+  }
+
+  static void onEdgeTimer(void* arg) {
+    ScheduleManager* self = static_cast<ScheduleManager*>(arg);
+    if(self->wakeCallback) self->wakeCallback();
+  }
 
   String getKey(uint8_t day, bool isStart) {
     return String("d") + day + (isStart ? "s" : "e");
   }
+
+  String getDayKey(uint8_t day) {
+    return String("w") + day;
+  }
 };
\ No newline at end of file
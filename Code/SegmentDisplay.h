@@ -0,0 +1,205 @@
+#pragma once
+#include <Arduino.h>
+
+// Неблокирующий драйвер TM1637 (4 разряда).
+// setSegments()/setBrightness() только запоминают желаемое состояние;
+// если оно совпадает с тем, что уже на индикаторе, передачи нет.
+// Сама передача - конечный автомат: каждый вызов step() выдает на шину
+// не больше BITS_PER_STEP тактов (старт, бит, ACK, стоп) и возвращает
+// управление. TM1637 тактируется CLK, так что паузы между вызовами
+// протоколу не мешают.
+//
+// Шина как у библиотеки TM1637Display: открытый сток, "1" - вывод в INPUT
+// (подтяжка), "0" - OUTPUT LOW. Все вызовы - из одной задачи.
+class SegmentDisplay {
+public:
+  struct Stats {
+    uint32_t requests = 0;  // Вызовы setSegments/setBrightness
+    uint32_t frames = 0;    // Завершенные передачи
+    uint32_t bytes = 0;
+    uint32_t nacks = 0;     // Байты без подтверждения от TM1637
+  };
+
+  static const uint8_t DIGITS = 4;
+  static const uint8_t COLON = 0x80; // Двоеточие - старший бит второго разряда
+  static const uint8_t MINUS = 0x40;
+
+  SegmentDisplay(uint8_t clk, uint8_t dio) : clkPin(clk), dioPin(dio) {}
+
+  void begin() {
+    pinMode(clkPin, INPUT);
+    pinMode(dioPin, INPUT);
+    digitalWrite(clkPin, LOW);
+    digitalWrite(dioPin, LOW);
+  }
+
+  static uint8_t encodeDigit(uint8_t digit) {
+    static const uint8_t digits[10] = {
+      0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F
+    };
+    return digits[digit % 10];
+  }
+
+  void setSegments(const uint8_t segments[DIGITS]) {
+    stats.requests++;
+    memcpy(wanted, segments, DIGITS);
+  }
+
+  // ЧЧ:ММ с ведущими нулями
+  void showTime(uint8_t hours, uint8_t minutes) {
+    uint8_t segments[DIGITS] = {
+      encodeDigit(hours / 10),
+      static_cast<uint8_t>(encodeDigit(hours % 10) | COLON),
+      encodeDigit(minutes / 10),
+      encodeDigit(minutes % 10)
+    };
+    setSegments(segments);
+  }
+
+  // 0..7
+  void setBrightness(uint8_t level, bool on = true) {
+    stats.requests++;
+    wantedControl = CMD_DISPLAY | (level & 0x07) | (on ? DISPLAY_ON : 0);
+  }
+
+  // true - нужно продолжить передачу следующим вызовом
+  bool step() {
+    if(phase == Phase::IDLE && !startFrame()) return false;
+
+    for(uint8_t clocks = 0; clocks < BITS_PER_STEP && phase != Phase::IDLE; clocks++) {
+      switch(phase) {
+        case Phase::START:
+          dioLow();
+          bitIndex = 0;
+          phase = Phase::BIT;
+          break;
+        case Phase::BIT:
+          writeBit(queue[position] & (1 << bitIndex));
+          if(++bitIndex == 8) phase = Phase::ACK;
+          break;
+        case Phase::ACK:
+          readAck();
+          stats.bytes++;
+          phase = (stopMask & (1 << position)) ? Phase::STOP : Phase::BIT;
+          position++;
+          bitIndex = 0;
+          break;
+        case Phase::STOP:
+          writeStop();
+          phase = (position < queueLength) ? Phase::START : Phase::IDLE;
+          break;
+        case Phase::IDLE:
+          break;
+      }
+    }
+
+    if(phase == Phase::IDLE) {
+      finishFrame();
+      return isPending();
+    }
+    return true;
+  }
+
+  bool isPending() const {
+    return phase != Phase::IDLE || !shownValid
+        || memcmp(wanted, shown, DIGITS) != 0 || wantedControl != shownControl;
+  }
+
+  const Stats& getStats() const {
+    return stats;
+  }
+
+private:
+  enum class Phase : uint8_t { IDLE, START, BIT, ACK, STOP };
+
+  static const uint8_t CMD_DATA = 0x40;     // Запись с автоинкрементом адреса
+  static const uint8_t CMD_ADDRESS = 0xC0;  // С первого разряда
+  static const uint8_t CMD_DISPLAY = 0x80;
+  static const uint8_t DISPLAY_ON = 0x08;
+  static const uint8_t BITS_PER_STEP = 12;
+  static const uint8_t BIT_DELAY_US = 5;
+
+  // Очередь одного кадра: команды и данные, после байтов из stopMask - стоп
+  bool startFrame() {
+    queueLength = 0;
+    stopMask = 0;
+    bool dataChanged = !shownValid || memcmp(wanted, shown, DIGITS) != 0;
+    if(dataChanged) {
+      memcpy(sending, wanted, DIGITS);
+      pushCommand(CMD_DATA, true);
+      pushCommand(CMD_ADDRESS, false);
+      for(uint8_t i = 0; i < DIGITS; i++) {
+        pushCommand(sending[i], i == DIGITS - 1);
+      }
+    }
+    if(!shownValid || wantedControl != shownControl) {
+      sendingControl = wantedControl;
+      pushCommand(sendingControl, true);
+    }
+    if(queueLength == 0) return false;
+
+    sendsData = dataChanged;
+    position = 0;
+    phase = Phase::START;
+    return true;
+  }
+
+  void pushCommand(uint8_t value, bool stop) {
+    if(stop) stopMask |= 1 << queueLength;
+    queue[queueLength++] = value;
+  }
+
+  void finishFrame() {
+    if(sendsData) memcpy(shown, sending, DIGITS);
+    shownControl = sendingControl;
+    shownValid = true;
+    stats.frames++;
+  }
+
+  void writeBit(bool value) {
+    clkLow();
+    if(value) dioHigh(); else dioLow();
+    clkHigh();
+  }
+
+  void readAck() {
+    clkLow();
+    dioHigh();
+    clkHigh();
+    if(digitalRead(dioPin) != LOW) stats.nacks++;
+    dioLow();
+    clkLow();
+  }
+
+  void writeStop() {
+    dioLow();
+    clkHigh();
+    dioHigh();
+  }
+
+  void clkLow()  { pinMode(clkPin, OUTPUT); delayMicroseconds(BIT_DELAY_US); }
+  void clkHigh() { pinMode(clkPin, INPUT);  delayMicroseconds(BIT_DELAY_US); }
+  void dioLow()  { pinMode(dioPin, OUTPUT); delayMicroseconds(BIT_DELAY_US); }
+  void dioHigh() { pinMode(dioPin, INPUT);  delayMicroseconds(BIT_DELAY_US); }
+
+  uint8_t clkPin;
+  uint8_t dioPin;
+
+  uint8_t wanted[DIGITS] = {};
+  uint8_t wantedControl = CMD_DISPLAY | DISPLAY_ON | 0x07;
+  uint8_t shown[DIGITS] = {};
+  uint8_t shownControl = 0;
+  bool shownValid = false;
+
+  uint8_t sending[DIGITS] = {};
+  uint8_t sendingControl = 0;
+  bool sendsData = false;
+  uint8_t queue[7] = {};
+  uint8_t queueLength = 0;
+  uint8_t stopMask = 0;
+  uint8_t position = 0;
+  uint8_t bitIndex = 0;
+  Phase phase = Phase::IDLE;
+
+  Stats stats;
+};
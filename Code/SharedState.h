@@ -0,0 +1,48 @@
+#pragma once
+#include <Arduino.h>
+#include "Pins.h"
+
+// Снимок состояния контура управления.
+// Пишет только задача управления, UI и сеть читают копию под спинлоком,
+// поэтому медленные потребители никогда не держат контур управления.
+struct SensorReading {
+  TempCenti temperature = 0;
+  TempCenti rawTemperature = 0;
+  int32_t slope = 0;           // Сотые °C/мин
+  bool failed = false;
+  TempCenti highThreshold = 0;
+  TempCenti lowThreshold = 0;
+  bool protects = true;
+};
+
+struct ControlSnapshot {
+  TempCenti temperature = 0;   // Самый горячий датчик из участвующих в защите
+  TempCenti rawTemperature = 0;
+  bool overheated = false;
+  int32_t slope = 0;           // Скорость роста, сотые °C/мин
+  int32_t predictedMs = -1;    // Прогноз достижения порога, -1 - не растет
+  unsigned long updatedAt = 0; // Время выборки датчика (millis)
+  uint8_t sensorCount = 0;
+  uint8_t hottestSensor = 0;
+  SensorReading sensors[MAX_TEMP_SENSORS];
+};
+
+class SharedState {
+public:
+  void publish(const ControlSnapshot& snapshot) {
+    portENTER_CRITICAL(&lock);
+    current = snapshot;
+    portEXIT_CRITICAL(&lock);
+  }
+
+  ControlSnapshot read() const {
+    portENTER_CRITICAL(&lock);
+    ControlSnapshot copy = current;
+    portEXIT_CRITICAL(&lock);
+    return copy;
+  }
+
+private:
+  mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+  ControlSnapshot current;
+};
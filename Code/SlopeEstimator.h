@@ -0,0 +1,103 @@
+#pragma once
+#include <Arduino.h>
+
+// Скорость изменения температуры методом наименьших квадратов
+// по скользящему окну из N последних выборок. Целочисленная арифметика:
+// время в мс, температура в сотых долях градуса.
+// Суммы обновляются инкрементально: при добавлении выборки вычитается
+// вытесненная, а начало отсчета времени переносится на самую старую выборку.
+template<uint8_t N>
+class SlopeEstimator {
+public:
+  static_assert(N >= 2, "slope needs at least two samples");
+
+  static constexpr uint8_t MIN_SAMPLES = (N / 2 > 2) ? N / 2 : 2;
+
+  void clear() {
+    count = 0;
+    head = 0;
+    sumX = sumY = sumXX = sumXY = 0;
+  }
+
+  void push(uint32_t timeMs, int32_t centi) {
+    if(count == N) {
+      // Вытесняем самую старую выборку
+      const Sample& old = samples[head];
+      int64_t x = (int32_t)(old.timeMs - baseMs);
+      sumX -= x;
+      sumY -= old.centi;
+      sumXX -= x * x;
+      sumXY -= x * old.centi;
+      count--;
+    }
+    samples[head] = {timeMs, centi};
+    head = (head + 1) % N;
+    count++;
+
+    if(count == 1) {
+      baseMs = timeMs;
+    } else {
+      rebase(samples[(head + N - count) % N].timeMs);
+    }
+
+    int64_t x = (int32_t)(timeMs - baseMs);
+    sumX += x;
+    sumY += centi;
+    sumXX += x * x;
+    sumXY += x * centi;
+  }
+
+  bool isReady() const {
+    return count >= MIN_SAMPLES;
+  }
+
+  uint8_t getCount() const {
+    return count;
+  }
+
+  // Наклон в сотых градуса за минуту (0 - данных недостаточно)
+  int32_t slopePerMinute() const {
+    if(!isReady()) return 0;
+    int64_t num = (int64_t)count * sumXY - sumX * sumY;
+    int64_t den = (int64_t)count * sumXX - sumX * sumX;
+    if(den <= 0) return 0;
+    // num * 60000 может не влезть в int64 - делим по частям
+    return (int32_t)((num / den) * 60000 + (num % den) * 60000 / den);
+  }
+
+  // Через сколько мс температура дойдет до target при текущем наклоне.
+  // -1 - не растет или данных недостаточно, 0 - уже на пороге.
+  int32_t timeToReachMs(int32_t currentCenti, int32_t targetCenti) const {
+    if(currentCenti >= targetCenti) return 0;
+    int32_t slope = slopePerMinute();
+    if(slope <= 0) return -1;
+    int64_t ms = (int64_t)(targetCenti - currentCenti) * 60000 / slope;
+    return ms > INT32_MAX ? INT32_MAX : (int32_t)ms;
+  }
+
+private:
+  struct Sample {
+    uint32_t timeMs;
+    int32_t centi;
+  };
+
+  Sample samples[N];
+  uint8_t head = 0;
+  uint8_t count = 0;
+  uint32_t baseMs = 0;
+  int64_t sumX = 0;
+  int64_t sumY = 0;
+  int64_t sumXX = 0;
+  int64_t sumXY = 0;
+
+  // Перенос начала отсчета: x' = x - d
+  void rebase(uint32_t newBaseMs) {
+    int64_t d = (int32_t)(newBaseMs - baseMs);
+    if(d == 0) return;
+    uint8_t n = count - 1; // Новая выборка еще не добавлена в суммы
+    sumXX += -2 * d * sumX + (int64_t)n * d * d;
+    sumXY -= d * sumY;
+    sumX -= (int64_t)n * d;
+    baseMs = newBaseMs;
+  }
+};
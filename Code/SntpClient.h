@@ -0,0 +1,189 @@
+#pragma once
+#include <Arduino.h>
+#include <Udp.h>
+
+// Неблокирующий SNTP-клиент (RFC 4330).
+// start() отправляет запросы сразу всем серверам, poll() вычитывает ответы
+// из сокета без ожидания. Побеждает выборка с минимальным RTT.
+// Локальное время передается снаружи, а транспорт - любой UDP, поэтому
+// движок проверяется на хосте против локального UDP-ответчика.
+class SntpClient {
+public:
+  static constexpr uint8_t MAX_SERVERS = 4;
+  static constexpr uint16_t NTP_PORT = 123;
+  static constexpr uint16_t LOCAL_PORT = 2390;
+  static constexpr uint32_t REPLY_TIMEOUT_US = 2000000;
+
+  enum class State {
+    IDLE,
+    WAITING,
+    DONE,
+    FAILED
+  };
+
+  struct Sample {
+    int64_t offsetUs = 0; // Время сервера минус локальное время
+    uint32_t rttUs = 0;
+    uint8_t server = 0;
+  };
+
+  SntpClient(UDP& udp) : udp(udp) {}
+
+  void setServer(uint8_t index, const IPAddress& address) {
+    if(index >= MAX_SERVERS) return;
+    servers[index].address = address;
+    servers[index].valid = (uint32_t)address != 0;
+  }
+
+  // localUs - локальное UTC-время в мкс с 1970 года
+  bool start(uint64_t localUs) {
+    if(!socketOpen) {
+      socketOpen = udp.begin(LOCAL_PORT) == 1;
+      if(!socketOpen) return false;
+    }
+    discardPending();
+
+    sent = 0;
+    replies = 0;
+    startUs = localUs;
+    best = Sample();
+    for(uint8_t i = 0; i < MAX_SERVERS; i++) {
+      Server& server = servers[i];
+      server.answered = false;
+      if(!server.valid) continue;
+
+      // Метка отправки уникальна для сервера: младший байт дроби - индекс
+      server.originUs = localUs;
+      server.origin = toNtp(localUs);
+      server.origin = (server.origin & ~0xFFULL) | i;
+
+      uint8_t packet[PACKET_SIZE] = {0};
+      packet[0] = 0x23; // LI = 0, VN = 4, Mode = 3 (клиент)
+      writeTimestamp(packet + 40, server.origin);
+      if(udp.beginPacket(server.address, NTP_PORT) &&
+         udp.write(packet, PACKET_SIZE) == PACKET_SIZE &&
+         udp.endPacket()) {
+        sent++;
+      }
+    }
+    state = sent > 0 ? State::WAITING : State::FAILED;
+    return sent > 0;
+  }
+
+  State poll(uint64_t localUs) {
+    if(state != State::WAITING) return state;
+
+    int size;
+    while((size = udp.parsePacket()) > 0) {
+      uint8_t packet[PACKET_SIZE];
+      if(size < PACKET_SIZE || udp.read(packet, PACKET_SIZE) != PACKET_SIZE) {
+        udp.flush();
+        continue;
+      }
+      handleReply(packet, localUs);
+    }
+
+    if(replies == sent || localUs - startUs > REPLY_TIMEOUT_US) {
+      state = replies > 0 ? State::DONE : State::FAILED;
+    }
+    return state;
+  }
+
+  void reset() {
+    state = State::IDLE;
+  }
+
+  State getState() const {
+    return state;
+  }
+
+  const Sample& getBest() const {
+    return best;
+  }
+
+  uint8_t getReplyCount() const {
+    return replies;
+  }
+
+private:
+  static constexpr int PACKET_SIZE = 48;
+  static constexpr uint64_t NTP_UNIX_OFFSET = 2208988800ULL; // 1900 -> 1970
+
+  struct Server {
+    IPAddress address;
+    bool valid = false;
+    bool answered = false;
+    uint64_t origin = 0;
+    uint64_t originUs = 0;
+  };
+
+  UDP& udp;
+  Server servers[MAX_SERVERS];
+  State state = State::IDLE;
+  bool socketOpen = false;
+  uint8_t sent = 0;
+  uint8_t replies = 0;
+  uint64_t startUs = 0;
+  Sample best;
+
+  void handleReply(const uint8_t* packet, uint64_t receiveUs) {
+    uint8_t mode = packet[0] & 0x07;
+    uint8_t stratum = packet[1];
+    if(mode != 4 || stratum == 0) return; // Не ответ сервера или Kiss-o'-Death
+
+    uint64_t origin = readTimestamp(packet + 24);
+    for(uint8_t i = 0; i < MAX_SERVERS; i++) {
+      Server& server = servers[i];
+      if(!server.valid || server.answered || server.origin != origin) continue;
+      server.answered = true;
+      replies++;
+
+      int64_t t1 = server.originUs;
+      int64_t t2 = fromNtp(readTimestamp(packet + 32));
+      int64_t t3 = fromNtp(readTimestamp(packet + 40));
+      int64_t t4 = receiveUs;
+
+      int64_t rtt = (t4 - t1) - (t3 - t2);
+      if(rtt < 0) rtt = 0;
+      if(best.rttUs == 0 || (uint32_t)rtt < best.rttUs) {
+        best.offsetUs = ((t2 - t1) + (t3 - t4)) / 2;
+        best.rttUs = rtt > 0 ? (uint32_t)rtt : 1;
+        best.server = i;
+      }
+      return;
+    }
+  }
+
+  void discardPending() {
+    while(udp.parsePacket() > 0) {
+      udp.flush();
+    }
+  }
+
+  static uint64_t toNtp(uint64_t unixUs) {
+    uint64_t seconds = unixUs / 1000000 + NTP_UNIX_OFFSET;
+    uint64_t fraction = ((unixUs % 1000000) << 32) / 1000000;
+    return (seconds << 32) | fraction;
+  }
+
+  static int64_t fromNtp(uint64_t ntp) {
+    uint64_t seconds = (ntp >> 32) - NTP_UNIX_OFFSET;
+    uint64_t fraction = ((ntp & 0xFFFFFFFFULL) * 1000000) >> 32;
+    return (int64_t)(seconds * 1000000 + fraction);
+  }
+
+  static uint64_t readTimestamp(const uint8_t* p) {
+    uint64_t value = 0;
+    for(int i = 0; i < 8; i++) {
+      value = (value << 8) | p[i];
+    }
+    return value;
+  }
+
+  static void writeTimestamp(uint8_t* p, uint64_t value) {
+    for(int i = 7; i >= 0; i--) {
+      p[i] = value & 0xFF;
+      value >>= 8;
+    }
+  }
+};
@@ -0,0 +1,237 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+// Кооперативный планировщик задач с дедлайнами.
+// Каждая подсистема регистрирует период (или срабатывает по событию),
+// а loop() спит до ближайшего дедлайна вместо фиксированной задержки.
+class TaskScheduler {
+public:
+  typedef void (*TaskCallback)();
+
+  static constexpr uint8_t MAX_TASKS = 10;
+  static constexpr uint8_t INVALID_TASK = 0xFF;
+  static constexpr unsigned long MAX_SLEEP_MS = 1000;
+
+  // Гистограмма длительности выполнения задач (сколько задача держит цикл):
+  // <100 мкс, <1 мс, <10 мс, <100 мс, <1 с, >=1 с
+  static constexpr uint8_t STALL_BUCKETS = 6;
+
+  struct TaskStats {
+    uint32_t runs = 0;
+    uint32_t overruns = 0;        // Выполнение дольше бюджета
+    uint32_t missedDeadlines = 0; // Старт опоздал больше чем на период
+    uint32_t maxDurationUs = 0;
+    uint64_t totalDurationUs = 0;
+    uint32_t maxLatenessMs = 0;
+  };
+
+  // periodMs == 0 - задача выполняется только по trigger()/scheduleIn()
+  uint8_t addTask(const char* name, TaskCallback callback,
+                  unsigned long periodMs, uint32_t budgetUs) {
+    if(taskCount >= MAX_TASKS || callback == nullptr) {
+      return INVALID_TASK;
+    }
+    Task& task = tasks[taskCount];
+    task.name = name;
+    task.callback = callback;
+    task.periodMs = periodMs;
+    task.budgetUs = budgetUs;
+    task.nextRun = millis();
+    task.pending = periodMs > 0;
+    return taskCount++;
+  }
+
+  // Привязка к текущей задаче FreeRTOS: сон прерывается событиями из ISR
+  void attachToCurrentTask() {
+    ownerTask = xTaskGetCurrentTaskHandle();
+  }
+
+  // Запуск задачи из обработчика прерывания
+  void IRAM_ATTR triggerFromISR(uint8_t id) {
+    if(id >= MAX_TASKS) return;
+    isrPending.fetch_or(1UL << id);
+    if(ownerTask != nullptr) {
+      BaseType_t woken = pdFALSE;
+      vTaskNotifyGiveFromISR(ownerTask, &woken);
+      portYIELD_FROM_ISR(woken);
+    }
+  }
+
+  // Запуск задачи из другой задачи FreeRTOS (или из таймера esp_timer)
+  void triggerAsync(uint8_t id) {
+    if(id >= MAX_TASKS) return;
+    isrPending.fetch_or(1UL << id);
+    if(ownerTask != nullptr) {
+      xTaskNotifyGive(ownerTask);
+    }
+  }
+
+  // Выполнить задачу как можно скорее
+  void trigger(uint8_t id) {
+    scheduleIn(id, 0);
+  }
+
+  // Перенести ближайший запуск задачи (например, на следующий фронт расписания)
+  void scheduleIn(uint8_t id, unsigned long delayMs) {
+    if(id >= taskCount) return;
+    tasks[id].nextRun = millis() + delayMs;
+    tasks[id].pending = true;
+    if(id == currentTask) {
+      rescheduled = true;
+    }
+  }
+
+  void setPeriod(uint8_t id, unsigned long periodMs) {
+    if(id >= taskCount) return;
+    tasks[id].periodMs = periodMs;
+  }
+
+  // Выполняет все задачи с наступившим дедлайном.
+  // Возвращает время в мс до ближайшего дедлайна.
+  unsigned long run() {
+    uint32_t external = isrPending.exchange(0);
+    for(uint8_t i = 0; external != 0 && i < taskCount; i++) {
+      if(external & (1UL << i)) {
+        tasks[i].nextRun = millis();
+        tasks[i].pending = true;
+      }
+    }
+
+    for(uint8_t i = 0; i < taskCount; i++) {
+      Task& task = tasks[i];
+      unsigned long now = millis();
+      if(!task.pending || (long)(now - task.nextRun) < 0) continue;
+
+      uint32_t lateness = now - task.nextRun;
+      if(lateness > task.stats.maxLatenessMs) {
+        task.stats.maxLatenessMs = lateness;
+      }
+      if(task.periodMs > 0 && lateness >= task.periodMs) {
+        task.stats.missedDeadlines++;
+      }
+
+      currentTask = i;
+      rescheduled = false;
+      unsigned long start = micros();
+      task.callback();
+      uint32_t duration = micros() - start;
+      currentTask = INVALID_TASK;
+
+      task.stats.runs++;
+      task.stats.totalDurationUs += duration;
+      stallHistogram[stallBucket(duration)]++;
+      if(duration > task.stats.maxDurationUs) {
+        task.stats.maxDurationUs = duration;
+      }
+      if(task.budgetUs > 0 && duration > task.budgetUs) {
+        task.stats.overruns++;
+      }
+
+      if(rescheduled) continue; // Задача сама назначила следующий запуск
+
+      if(task.periodMs > 0) {
+        task.nextRun += task.periodMs;
+        // Отстали больше чем на период - не догоняем пачкой запусков
+        if((long)(millis() - task.nextRun) >= 0) {
+          task.nextRun = millis() + task.periodMs;
+        }
+      } else {
+        task.pending = false;
+      }
+    }
+    return timeUntilNextDeadline();
+  }
+
+  unsigned long timeUntilNextDeadline() const {
+    unsigned long now = millis();
+    unsigned long wait = MAX_SLEEP_MS;
+    for(uint8_t i = 0; i < taskCount; i++) {
+      if(!tasks[i].pending) continue;
+      long remaining = (long)(tasks[i].nextRun - now);
+      if(remaining <= 0) return 0;
+      if((unsigned long)remaining < wait) {
+        wait = remaining;
+      }
+    }
+    return wait;
+  }
+
+  void sleepUntilNextDeadline() {
+    unsigned long wait = timeUntilNextDeadline();
+    if(wait == 0) return;
+    if(ownerTask != nullptr) {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait)); // Будит triggerFromISR()
+    } else {
+      delay(wait);
+    }
+  }
+
+  uint8_t getTaskCount() const {
+    return taskCount;
+  }
+
+  const char* getTaskName(uint8_t id) const {
+    return id < taskCount ? tasks[id].name : "";
+  }
+
+  const TaskStats& getStats(uint8_t id) const {
+    return tasks[id < taskCount ? id : 0].stats;
+  }
+
+  void resetStats() {
+    for(uint8_t i = 0; i < taskCount; i++) {
+      tasks[i].stats = TaskStats();
+    }
+    memset(stallHistogram, 0, sizeof(stallHistogram));
+  }
+
+  const uint32_t* getStallHistogram() const {
+    return stallHistogram;
+  }
+
+  void printStats(Print& out) const {
+    out.println("task        runs  avg_us  max_us  overruns  missed  max_late_ms");
+    for(uint8_t i = 0; i < taskCount; i++) {
+      const TaskStats& s = tasks[i].stats;
+      uint32_t avg = s.runs ? (uint32_t)(s.totalDurationUs / s.runs) : 0;
+      out.printf("%-10s %6u %7u %7u %9u %7u %12u\n",
+                 tasks[i].name, (unsigned)s.runs, (unsigned)avg,
+                 (unsigned)s.maxDurationUs, (unsigned)s.overruns,
+                 (unsigned)s.missedDeadlines, (unsigned)s.maxLatenessMs);
+    }
+    out.printf("stall: <100us=%u <1ms=%u <10ms=%u <100ms=%u <1s=%u >=1s=%u\n",
+               (unsigned)stallHistogram[0], (unsigned)stallHistogram[1],
+               (unsigned)stallHistogram[2], (unsigned)stallHistogram[3],
+               (unsigned)stallHistogram[4], (unsigned)stallHistogram[5]);
+  }
+
+private:
+  struct Task {
+    const char* name = "";
+    TaskCallback callback = nullptr;
+    unsigned long periodMs = 0;
+    uint32_t budgetUs = 0;
+    unsigned long nextRun = 0;
+    bool pending = false;
+    TaskStats stats;
+  };
+
+  Task tasks[MAX_TASKS];
+  uint8_t taskCount = 0;
+  uint8_t currentTask = INVALID_TASK;
+  bool rescheduled = false;
+  TaskHandle_t ownerTask = nullptr;
+  std::atomic<uint32_t> isrPending{0};
+  uint32_t stallHistogram[STALL_BUCKETS] = {0};
+
+  static uint8_t stallBucket(uint32_t durationUs) {
+    uint8_t bucket = 0;
+    uint32_t limit = 100;
+    while(bucket < STALL_BUCKETS - 1 && durationUs >= limit) {
+      bucket++;
+      limit *= 10;
+    }
+    return bucket;
+  }
+};
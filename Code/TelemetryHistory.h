@@ -0,0 +1,315 @@
+#pragma once
+#include <Arduino.h>
+#include "Pins.h"
+
+// История температуры и состояния реле в ОЗУ, три яруса:
+// секунды (HISTORY_SECONDS), минуты (HISTORY_MINUTES), часы (HISTORY_HOURS).
+// Секундный ярус хранит разности int16 в сотых градуса + байт флагов,
+// старшие ярусы - min/max/среднее, собранные инкрементально из аккумуляторов
+// без повторного прохода по буферам. Размер фиксирован на этапе компиляции.
+// Пишет задача управления, читает сетевая - порциями под спинлоком.
+class TelemetryHistory {
+public:
+  enum Flags : uint8_t {
+    FLAG_RELAY_ON = 0x01,
+    FLAG_BLOCKED  = 0x02,
+    FLAG_OVERHEAT = 0x04,
+    FLAG_VALID    = 0x80  // 0 - в эту секунду выборки не было
+  };
+
+  enum Tier : uint8_t {
+    TIER_SECONDS,
+    TIER_MINUTES,
+    TIER_HOURS
+  };
+
+  // Выборка секундного яруса (уже декодированная)
+  struct Sample {
+    uint32_t time;
+    TempCenti centi;
+    uint8_t flags;
+  };
+
+  // Запись минутного/часового яруса. Время - начало периода.
+  struct Rollup {
+    uint32_t time;
+    TempCenti minCenti;
+    TempCenti maxCenti;
+    TempCenti meanCenti;
+    uint8_t relayOnPercent;
+    uint8_t flags;        // OR флагов всех выборок периода
+  };
+
+  // Позиция чтения: переживает сдвиг буфера между порциями и clear()
+  struct Cursor {
+    uint32_t seq = 0;
+    int16_t centi = 0;    // Значение выборки seq - 1 (для декодирования разностей)
+    bool started = false;
+    uint32_t generation = 0; // Номер истории после clear(), в которой получен seq
+  };
+
+  static constexpr size_t MEMORY_BYTES =
+      HISTORY_SECONDS * (sizeof(int16_t) + sizeof(uint8_t)) +
+      (HISTORY_MINUTES + HISTORY_HOURS) * (3 * sizeof(int16_t) + 2 * sizeof(uint8_t));
+
+  void clear() {
+    portENTER_CRITICAL(&lock);
+    secondsTotal = 0;
+    minutes.total = 0;
+    hours.total = 0;
+    minuteAcc = Accumulator();
+    hourAcc = Accumulator();
+    // Курсоры старой истории указывают дальше новых total
+    generation++;
+    portEXIT_CRITICAL(&lock);
+  }
+
+  // Вызывается раз в секунду задачей управления
+  void record(uint32_t epoch, TempCenti centi, uint8_t flags) {
+    flags |= FLAG_VALID;
+    portENTER_CRITICAL(&lock);
+    if(secondsTotal > 0 && epoch <= secondsLast) {
+      portEXIT_CRITICAL(&lock);
+      // Часы переведены назад: мелкие коррекции пропускаем, крупные сбрасывают историю
+      if(secondsLast - epoch > 3600) clear();
+      return;
+    }
+
+    if(secondsTotal > 0) {
+      uint32_t gap = epoch - secondsLast - 1;
+      for(uint32_t i = 0; i < gap && i < HISTORY_SECONDS; i++) {
+        pushSecond(lastCenti, 0);
+      }
+    }
+    pushSecond(centi, flags);
+    secondsLast = epoch;
+
+    uint32_t minute = epoch / 60;
+    if(minuteAcc.count > 0 && minute != minuteAcc.period) {
+      closeMinute();
+    }
+    minuteAcc.add(minute, centi, flags);
+    portEXIT_CRITICAL(&lock);
+  }
+
+  // Первая позиция с временем >= from
+  Cursor seek(Tier tier, uint32_t from) const {
+    portENTER_CRITICAL(&lock);
+    uint32_t total, last, step, capacity;
+    describe(tier, total, last, step, capacity);
+    Cursor cursor;
+    cursor.generation = generation;
+    cursor.seq = total > capacity ? total - capacity : 0;
+    if(total > 0 && from > last - (total - 1 - cursor.seq) * step) {
+      uint32_t back = (last >= from) ? (last - from) / step : 0;
+      cursor.seq = (last >= from) ? total - 1 - back : total;
+    }
+    portEXIT_CRITICAL(&lock);
+    return cursor;
+  }
+
+  // Копирует до max выборок начиная с cursor. Возвращает число скопированных.
+  uint16_t readSeconds(Cursor& cursor, Sample* out, uint16_t max) const {
+    portENTER_CRITICAL(&lock);
+    restart(cursor);
+    uint32_t oldest = secondsTotal > HISTORY_SECONDS ? secondsTotal - HISTORY_SECONDS : 0;
+    if(cursor.seq < oldest) {
+      cursor.seq = oldest; // Данные вытеснены, пока читалась прошлая порция
+      cursor.started = false;
+    }
+    uint16_t copied = 0;
+    while(copied < max && cursor.seq < secondsTotal) {
+      uint16_t index = cursor.seq % HISTORY_SECONDS;
+      int16_t centi = (!cursor.started || cursor.seq == oldest)
+          ? valueAt(cursor.seq, oldest)
+          : cursor.centi + deltas[index];
+      out[copied++] = {secondsLast - (secondsTotal - 1 - cursor.seq), centi, flagBits[index]};
+      cursor.centi = centi;
+      cursor.started = true;
+      cursor.seq++;
+    }
+    portEXIT_CRITICAL(&lock);
+    return copied;
+  }
+
+  uint16_t readRollups(Tier tier, Cursor& cursor, Rollup* out, uint16_t max) const {
+    if(tier == TIER_SECONDS) return 0;
+    portENTER_CRITICAL(&lock);
+    restart(cursor);
+    uint16_t copied = (tier == TIER_MINUTES)
+        ? minutes.read(cursor, out, max, 60)
+        : hours.read(cursor, out, max, 3600);
+    portEXIT_CRITICAL(&lock);
+    return copied;
+  }
+
+  uint32_t getCount(Tier tier) const {
+    portENTER_CRITICAL(&lock);
+    uint32_t total, last, step, capacity;
+    describe(tier, total, last, step, capacity);
+    portEXIT_CRITICAL(&lock);
+    return total < capacity ? total : capacity;
+  }
+
+private:
+  template<uint16_t N>
+  struct RollupRing {
+    int16_t minCenti[N];
+    int16_t maxCenti[N];
+    int16_t meanCenti[N];
+    uint8_t relayOn[N];
+    uint8_t flags[N];
+    uint32_t total = 0;
+    uint32_t last = 0;    // Начало периода самой новой записи
+
+    void push(uint32_t time, uint32_t step, const Rollup& entry) {
+      if(total > 0) {
+        uint32_t gap = (time - last) / step;
+        for(uint32_t i = 1; i < gap && i <= N; i++) {
+          Rollup empty = {0, 0, 0, 0, 0, 0};
+          store(empty);
+        }
+      }
+      store(entry);
+      last = time;
+    }
+
+    void store(const Rollup& entry) {
+      uint16_t index = total % N;
+      minCenti[index] = entry.minCenti;
+      maxCenti[index] = entry.maxCenti;
+      meanCenti[index] = entry.meanCenti;
+      relayOn[index] = entry.relayOnPercent;
+      flags[index] = entry.flags;
+      total++;
+    }
+
+    uint16_t read(Cursor& cursor, Rollup* out, uint16_t max, uint32_t step) const {
+      uint32_t oldest = total > N ? total - N : 0;
+      if(cursor.seq < oldest) cursor.seq = oldest;
+      uint16_t copied = 0;
+      while(copied < max && cursor.seq < total) {
+        uint16_t index = cursor.seq % N;
+        out[copied] = {last - (total - 1 - cursor.seq) * step, minCenti[index], maxCenti[index],
+                       meanCenti[index], relayOn[index], flags[index]};
+        copied++;
+        cursor.seq++;
+      }
+      return copied;
+    }
+  };
+
+  struct Accumulator {
+    uint32_t period = 0;  // Номер минуты/часа с начала эпохи
+    int16_t minCenti = 0;
+    int16_t maxCenti = 0;
+    int32_t sum = 0;
+    uint16_t count = 0;
+    uint16_t onCount = 0;
+    uint8_t flags = 0;
+
+    void add(uint32_t newPeriod, int16_t centi, uint8_t sampleFlags) {
+      if(count == 0) {
+        period = newPeriod;
+        minCenti = maxCenti = centi;
+      }
+      if(centi < minCenti) minCenti = centi;
+      if(centi > maxCenti) maxCenti = centi;
+      sum += centi;
+      count++;
+      if(sampleFlags & FLAG_RELAY_ON) onCount++;
+      flags |= sampleFlags;
+    }
+
+    // Слияние закрытого периода младшего яруса
+    void merge(uint32_t newPeriod, const Accumulator& other) {
+      if(count == 0) {
+        period = newPeriod;
+        minCenti = other.minCenti;
+        maxCenti = other.maxCenti;
+      }
+      if(other.minCenti < minCenti) minCenti = other.minCenti;
+      if(other.maxCenti > maxCenti) maxCenti = other.maxCenti;
+      sum += other.sum;
+      count += other.count;
+      onCount += other.onCount;
+      flags |= other.flags;
+    }
+
+    Rollup toRollup(uint32_t time) const {
+      return {time, minCenti, maxCenti, (int16_t)(sum / count),
+              (uint8_t)(onCount * 100 / count), flags};
+    }
+  };
+
+  mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+  int16_t deltas[HISTORY_SECONDS];
+  uint8_t flagBits[HISTORY_SECONDS];
+  uint32_t secondsTotal = 0;
+  uint32_t secondsLast = 0;
+  int16_t secondsBase = 0;   // Значение самой старой выборки в буфере
+  int16_t lastCenti = 0;     // Значение самой новой выборки
+
+  RollupRing<HISTORY_MINUTES> minutes;
+  RollupRing<HISTORY_HOURS> hours;
+  Accumulator minuteAcc;
+  Accumulator hourAcc;
+  uint32_t generation = 0;
+
+  // Под lock. После clear() чтение продолжается с начала новой истории
+  void restart(Cursor& cursor) const {
+    if(cursor.generation == generation) return;
+    cursor = Cursor();
+    cursor.generation = generation;
+  }
+
+  void pushSecond(int16_t centi, uint8_t flags) {
+    uint16_t index = secondsTotal % HISTORY_SECONDS;
+    if(secondsTotal == 0) {
+      secondsBase = centi;
+    } else if(secondsTotal >= HISTORY_SECONDS) {
+      // Вытесняем самую старую: базой становится следующая за ней
+      secondsBase += deltas[(secondsTotal + 1) % HISTORY_SECONDS];
+    }
+    deltas[index] = (secondsTotal == 0) ? 0 : centi - lastCenti;
+    flagBits[index] = flags;
+    lastCenti = centi;
+    secondsTotal++;
+  }
+
+  // Декодирование с самой старой выборки - только при первом чтении
+  int16_t valueAt(uint32_t seq, uint32_t oldest) const {
+    int16_t centi = secondsBase;
+    for(uint32_t s = oldest + 1; s <= seq; s++) {
+      centi += deltas[s % HISTORY_SECONDS];
+    }
+    return centi;
+  }
+
+  void closeMinute() {
+    minutes.push(minuteAcc.period * 60, 60, minuteAcc.toRollup(minuteAcc.period * 60));
+    uint32_t hour = minuteAcc.period / 60;
+    if(hourAcc.count > 0 && hour != hourAcc.period) {
+      hours.push(hourAcc.period * 3600, 3600, hourAcc.toRollup(hourAcc.period * 3600));
+      hourAcc = Accumulator();
+    }
+    hourAcc.merge(hour, minuteAcc);
+    minuteAcc = Accumulator();
+  }
+
+  void describe(Tier tier, uint32_t& total, uint32_t& last,
+                uint32_t& step, uint32_t& capacity) const {
+    switch(tier) {
+      case TIER_MINUTES:
+        total = minutes.total; last = minutes.last; step = 60; capacity = HISTORY_MINUTES;
+        break;
+      case TIER_HOURS:
+        total = hours.total; last = hours.last; step = 3600; capacity = HISTORY_HOURS;
+        break;
+      default:
+        total = secondsTotal; last = secondsLast; step = 1; capacity = HISTORY_SECONDS;
+        break;
+    }
+  }
+};
@@ -0,0 +1,495 @@
+#pragma once
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "BitStream.h"
+#include "TelemetryHistory.h"
+#include "Pins.h"
+
+// Долговременный журнал во флеше (LittleFS): минутные записи истории
+// (min/max/среднее, доля работы реле, флаги) недели напролет.
+// Записи пакуются в сжатые блоки: время - разность разностей
+// (при ровном шаге 1 бит), значения - разности с предыдущей записью.
+// Блок запечатывается при заполнении LOG_BLOCK_BYTES или по истечении
+// LOG_BLOCK_SPAN и дописывается в файл сегмента одной записью - флеш
+// пишется примерно раз в час. Заголовок блока служит индексом: диапазон
+// времени, время работы реле и максимум, поэтому запрос диапазона
+// пропускает ненужные блоки без распаковки.
+// При превышении LOG_MAX_BYTES самый старый сегмент ужимается до часовых
+// записей, а уже ужатые удаляются.
+// Все методы вызываются только из сетевой задачи.
+class TelemetryLog {
+public:
+  struct Stats {
+    uint32_t blocksWritten = 0;
+    uint32_t bytesWritten = 0;
+    uint32_t compactions = 0;
+    uint32_t deletions = 0;
+    uint32_t writeErrors = 0;
+    uint32_t maxWriteUs = 0;  // Самая долгая запись блока
+  };
+
+  TelemetryLog(const TelemetryHistory& history) : history(history) {}
+
+  bool init() {
+    mounted = LittleFS.begin(true); // Форматирование при первом запуске
+    if(!mounted) {
+      Serial.println("LittleFS mount failed!");
+      return false;
+    }
+    if(!LittleFS.exists(LOG_DIR)) {
+      LittleFS.mkdir(LOG_DIR);
+    }
+    scanSegments();
+    openBlock.begin(60);
+    return true;
+  }
+
+  // Забирает закрытые минуты из истории в ОЗУ и пишет готовые блоки
+  void update() {
+    if(!mounted) return;
+    TelemetryHistory::Rollup rollups[16];
+    uint16_t count;
+    while((count = history.readRollups(TelemetryHistory::TIER_MINUTES, cursor, rollups, 16)) > 0) {
+      for(uint16_t i = 0; i < count; i++) {
+        if(!(rollups[i].flags & TelemetryHistory::FLAG_VALID)) continue;
+        // Повтор уже записанного (мелкая коррекция часов назад) пропускаем
+        if(rollups[i].time <= lastAppend && lastAppend - rollups[i].time < LOG_BLOCK_SPAN) continue;
+        append(rollups[i]);
+      }
+    }
+    if(openBlock.header.count > 0 && lastAppend - openBlock.header.firstTime >= LOG_BLOCK_SPAN) {
+      seal();
+    }
+  }
+
+  // Записать неполный блок (например, перед перезагрузкой)
+  void flush() {
+    if(mounted) seal();
+  }
+
+  // Перебор записей диапазона [from, to] по порядку времени, не больше limit.
+  // Возвращает число выданных записей; продолжение - с времени последней + 1.
+  // В памяти одновременно только один блок.
+  template<typename Emit>
+  uint16_t query(uint32_t from, uint32_t to, uint16_t limit, Emit emit) {
+    if(!mounted) return 0;
+    uint16_t remaining = limit;
+    for(uint8_t i = 0; i < segmentCount && remaining > 0; i++) {
+      if(segments[i].last < from || segments[i].first > to) continue;
+      File file = LittleFS.open(segmentPath(segments[i].seq).c_str(), "r");
+      if(!file) continue;
+      BlockHeader header;
+      while(remaining > 0 && file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) && header.isValid()) {
+        if(header.lastTime < from || header.firstTime > to) {
+          file.seek(file.position() + header.payloadBytes);
+          continue;
+        }
+        if(file.read(readBuffer, header.payloadBytes) != header.payloadBytes) break;
+        decodeBlock(header, readBuffer, from, to, remaining, emit);
+      }
+      file.close();
+    }
+    // Еще не записанный блок
+    if(openBlock.header.count > 0 && remaining > 0) {
+      BlockHeader header = openBlock.header;
+      header.payloadBytes = openBlock.writer.bytesUsed();
+      decodeBlock(header, openBlock.buffer, from, to, remaining, emit);
+    }
+    return limit - remaining;
+  }
+
+  uint32_t getBytesUsed() const {
+    uint32_t total = 0;
+    for(uint8_t i = 0; i < segmentCount; i++) {
+      total += segments[i].size;
+    }
+    return total;
+  }
+
+  uint8_t getSegmentCount() const {
+    return segmentCount;
+  }
+
+  const Stats& getStats() const {
+    return stats;
+  }
+
+private:
+  static constexpr const char* LOG_DIR = "/log";
+  static constexpr uint16_t BLOCK_MAGIC = 0x4254;
+  static constexpr uint16_t MAX_ENTRY_BITS = 4 * 35 + 8 + 9; // Худший случай кодирования записи
+
+  struct BlockHeader {
+    uint16_t magic = BLOCK_MAGIC;
+    uint16_t step = 60;           // Шаг записей, с: 60 - минуты, 3600 - ужатый сегмент
+    uint16_t count = 0;
+    uint16_t payloadBytes = 0;
+    uint32_t firstTime = 0;
+    uint32_t lastTime = 0;
+    uint32_t onSeconds = 0;       // Время работы реле за блок
+    int16_t maxCenti = INT16_MIN;
+    uint16_t reserved = 0;
+
+    bool isValid() const {
+      return magic == BLOCK_MAGIC && payloadBytes <= LOG_BLOCK_BYTES && count > 0;
+    }
+  };
+
+  // Сжатие записей одного блока
+  struct BlockEncoder {
+    uint8_t buffer[LOG_BLOCK_BYTES];
+    BitWriter writer{buffer, LOG_BLOCK_BYTES};
+    BlockHeader header;
+    uint32_t prevTime = 0;
+    int32_t prevDelta = 0;
+    int16_t prevMean = 0;
+    uint8_t prevPercent = 0;
+    uint8_t prevFlags = 0;
+
+    void begin(uint16_t step) {
+      writer.reset();
+      header = BlockHeader();
+      header.step = step;
+      prevDelta = step;
+      prevMean = 0;
+      prevPercent = 0;
+      prevFlags = 0;
+    }
+
+    bool hasRoom() const {
+      return writer.bitsFree() >= MAX_ENTRY_BITS;
+    }
+
+    void append(const TelemetryHistory::Rollup& entry) {
+      if(header.count == 0) {
+        header.firstTime = entry.time;
+        prevTime = entry.time;
+      } else {
+        int32_t delta = entry.time - prevTime;
+        writer.writeSigned(delta - prevDelta);
+        prevDelta = delta;
+        prevTime = entry.time;
+      }
+      writer.writeSigned(entry.meanCenti - prevMean);
+      writer.writeSigned(entry.maxCenti - entry.meanCenti);
+      writer.writeSigned(entry.meanCenti - entry.minCenti);
+      writeIfChanged(entry.relayOnPercent, prevPercent, 7);
+      writeIfChanged(entry.flags, prevFlags, 8);
+      prevMean = entry.meanCenti;
+
+      header.count++;
+      header.lastTime = entry.time;
+      header.onSeconds += (uint32_t)entry.relayOnPercent * header.step / 100;
+      if(entry.maxCenti > header.maxCenti) header.maxCenti = entry.maxCenti;
+    }
+
+    void writeIfChanged(uint8_t value, uint8_t& previous, uint8_t bits) {
+      if(value == previous) {
+        writer.write(0, 1);
+      } else {
+        writer.write(1, 1);
+        writer.write(value, bits);
+        previous = value;
+      }
+    }
+  };
+
+  // Накопитель часовой записи при ужатии сегмента
+  struct HourAccumulator {
+    TelemetryHistory::Rollup entry;
+    int32_t meanSum = 0;
+    uint32_t percentSum = 0;
+    uint16_t count = 0;
+
+    void add(const TelemetryHistory::Rollup& minute) {
+      if(count == 0) {
+        entry = minute;
+        entry.time = minute.time / 3600 * 3600;
+      }
+      if(minute.minCenti < entry.minCenti) entry.minCenti = minute.minCenti;
+      if(minute.maxCenti > entry.maxCenti) entry.maxCenti = minute.maxCenti;
+      entry.flags |= minute.flags;
+      meanSum += minute.meanCenti;
+      percentSum += minute.relayOnPercent;
+      count++;
+    }
+
+    TelemetryHistory::Rollup finish() {
+      entry.meanCenti = meanSum / count;
+      entry.relayOnPercent = percentSum / count;
+      count = 0;
+      meanSum = 0;
+      percentSum = 0;
+      return entry;
+    }
+  };
+
+  struct Segment {
+    uint32_t seq = 0;
+    uint32_t first = 0;
+    uint32_t last = 0;
+    uint32_t size = 0;
+    bool coarse = false;
+  };
+
+  const TelemetryHistory& history;
+  TelemetryHistory::Cursor cursor;
+  bool mounted = false;
+  Segment segments[LOG_MAX_SEGMENTS];
+  uint8_t segmentCount = 0;
+  BlockEncoder openBlock;
+  uint8_t readBuffer[LOG_BLOCK_BYTES];
+  uint32_t lastAppend = 0;
+  Stats stats;
+
+  template<typename Emit>
+  static void decodeBlock(const BlockHeader& header, const uint8_t* payload,
+                          uint32_t from, uint32_t to, uint16_t& remaining, Emit& emit) {
+    BitReader reader(payload, header.payloadBytes);
+    uint32_t time = header.firstTime;
+    int32_t delta = header.step;
+    int16_t mean = 0;
+    uint8_t percent = 0;
+    uint8_t flags = 0;
+    for(uint16_t i = 0; i < header.count && remaining > 0; i++) {
+      if(i > 0) {
+        delta += reader.readSigned();
+        time += delta;
+      }
+      mean += reader.readSigned();
+      int16_t maxCenti = mean + reader.readSigned();
+      int16_t minCenti = mean - reader.readSigned();
+      if(reader.read(1)) percent = reader.read(7);
+      if(reader.read(1)) flags = reader.read(8);
+      if(reader.isOverrun()) return; // Поврежденный блок
+      if(time < from) continue;
+      if(time > to) return;
+      TelemetryHistory::Rollup entry = {time, minCenti, maxCenti, mean, percent, flags};
+      emit(entry);
+      remaining--;
+    }
+  }
+
+  void append(const TelemetryHistory::Rollup& entry) {
+    if(openBlock.header.count > 0 &&
+       (!openBlock.hasRoom() || entry.time - openBlock.header.firstTime >= LOG_BLOCK_SPAN)) {
+      seal();
+    }
+    openBlock.append(entry);
+    lastAppend = entry.time;
+  }
+
+  void seal() {
+    if(openBlock.header.count == 0) return;
+    openBlock.header.payloadBytes = openBlock.writer.bytesUsed();
+    writeBlock(openBlock.header, openBlock.buffer);
+    openBlock.begin(60);
+    enforceCap();
+  }
+
+  bool writeBlock(const BlockHeader& header, const uint8_t* payload) {
+    uint32_t blockSize = sizeof(header) + header.payloadBytes;
+    if(segmentCount == 0 ||
+       segments[segmentCount - 1].size + blockSize > LOG_SEGMENT_BYTES) {
+      if(segmentCount == LOG_MAX_SEGMENTS) removeSegment(0);
+      Segment segment;
+      segment.seq = segmentCount ? segments[segmentCount - 1].seq + 1 : 0;
+      segment.first = header.firstTime;
+      segments[segmentCount++] = segment;
+    }
+    Segment& segment = segments[segmentCount - 1];
+
+    unsigned long start = micros();
+    File file = LittleFS.open(segmentPath(segment.seq).c_str(), "a");
+    bool ok = file &&
+              file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              file.write(payload, header.payloadBytes) == header.payloadBytes;
+    if(file) file.close();
+    uint32_t duration = micros() - start;
+    if(duration > stats.maxWriteUs) stats.maxWriteUs = duration;
+
+    if(!ok) {
+      stats.writeErrors++;
+      return false;
+    }
+    segment.size += blockSize;
+    segment.last = header.lastTime;
+    stats.blocksWritten++;
+    stats.bytesWritten += blockSize;
+    return true;
+  }
+
+  // Старые минутные сегменты ужимаются до часовых, ужатые - удаляются
+  void enforceCap() {
+    while(getBytesUsed() > LOG_MAX_BYTES && segmentCount > 1) {
+      uint8_t target = 0;
+      while(target < segmentCount - 1 && segments[target].coarse) {
+        target++;
+      }
+      if(target < segmentCount - 1 && compactSegment(target)) {
+        continue;
+      }
+      removeSegment(0);
+    }
+  }
+
+  bool compactSegment(uint8_t index) {
+    Segment& segment = segments[index];
+    String path = segmentPath(segment.seq);
+    String tmpPath = segmentPath(segment.seq, "tmp");
+    File source = LittleFS.open(path.c_str(), "r");
+    File target = LittleFS.open(tmpPath.c_str(), "w");
+    if(!source || !target) {
+      if(source) source.close();
+      if(target) target.close();
+      return false;
+    }
+
+    // Отдельный кодировщик: открытый блок журнала не трогаем
+    BlockEncoder coarse;
+    coarse.begin(3600);
+    HourAccumulator hour;
+    uint32_t size = 0;
+    bool ok = true;
+    auto writeCoarse = [&]() {
+      coarse.header.payloadBytes = coarse.writer.bytesUsed();
+      ok &= target.write((const uint8_t*)&coarse.header, sizeof(BlockHeader)) == sizeof(BlockHeader);
+      ok &= target.write(coarse.buffer, coarse.header.payloadBytes) == coarse.header.payloadBytes;
+      size += sizeof(BlockHeader) + coarse.header.payloadBytes;
+      coarse.begin(3600);
+    };
+    auto addHour = [&](const TelemetryHistory::Rollup& entry) {
+      if(coarse.header.count > 0 && !coarse.hasRoom()) writeCoarse();
+      coarse.append(entry);
+    };
+    auto addMinute = [&](const TelemetryHistory::Rollup& minute) {
+      if(hour.count > 0 && minute.time / 3600 * 3600 != hour.entry.time) {
+        addHour(hour.finish());
+      }
+      hour.add(minute);
+    };
+
+    BlockHeader header;
+    while(source.read((uint8_t*)&header, sizeof(header)) == sizeof(header) && header.isValid()) {
+      if(source.read(readBuffer, header.payloadBytes) != header.payloadBytes) break;
+      uint16_t unlimited = UINT16_MAX;
+      decodeBlock(header, readBuffer, 0, UINT32_MAX, unlimited, addMinute);
+    }
+    if(hour.count > 0) addHour(hour.finish());
+    if(coarse.header.count > 0) writeCoarse();
+    source.close();
+    target.close();
+
+    if(!ok) {
+      LittleFS.remove(tmpPath.c_str());
+      stats.writeErrors++;
+      return false;
+    }
+    // rename в LittleFS атомарно заменяет сегмент: при сбросе на диске остается
+    // либо исходный файл, либо ужатый, но не ни одного
+    if(!LittleFS.rename(tmpPath.c_str(), path.c_str())) {
+      LittleFS.remove(tmpPath.c_str());
+      stats.writeErrors++;
+      return false;
+    }
+    segment.size = size;
+    segment.coarse = true;
+    stats.compactions++;
+    return true;
+  }
+
+  void removeSegment(uint8_t index) {
+    LittleFS.remove(segmentPath(segments[index].seq).c_str());
+    for(uint8_t i = index; i + 1 < segmentCount; i++) {
+      segments[i] = segments[i + 1];
+    }
+    segmentCount--;
+    stats.deletions++;
+  }
+
+  // Восстановление таблицы сегментов при старте: читаются только заголовки блоков
+  void scanSegments() {
+    segmentCount = 0;
+    File dir = LittleFS.open(LOG_DIR);
+    if(!dir) return;
+    // Файлы .tmp разбираются после обхода: переименование во время обхода
+    // могло бы показать тот же файл второй раз
+    uint32_t tmpSeqs[LOG_MAX_SEGMENTS];
+    uint8_t tmpCount = 0;
+    File file;
+    while((file = dir.openNextFile())) {
+      String name = file.name();
+      int slash = name.lastIndexOf('/');
+      if(slash >= 0) name = name.substring(slash + 1);
+      if(name.endsWith(".seg")) {
+        addScannedSegment(file, name.toInt());
+      } else if(name.endsWith(".tmp") && isdigit((unsigned char)name[0]) && tmpCount < LOG_MAX_SEGMENTS) {
+        tmpSeqs[tmpCount++] = name.toInt();
+      } else {
+        LittleFS.remove((String(LOG_DIR) + "/" + name).c_str());
+      }
+      file.close();
+    }
+    dir.close();
+
+    // Рядом с исходным .tmp - остаток прерванного ужатия, удаляется. Без исходного
+    // (замена не завершилась) это единственная копия данных - она становится сегментом.
+    for(uint8_t i = 0; i < tmpCount; i++) {
+      String tmpPath = segmentPath(tmpSeqs[i], "tmp");
+      String path = segmentPath(tmpSeqs[i]);
+      if(LittleFS.exists(path.c_str()) || !LittleFS.rename(tmpPath.c_str(), path.c_str())) {
+        LittleFS.remove(tmpPath.c_str());
+        continue;
+      }
+      File restored = LittleFS.open(path.c_str(), "r");
+      if(!restored) continue;
+      addScannedSegment(restored, tmpSeqs[i]);
+      restored.close();
+    }
+  }
+
+  void addScannedSegment(File& file, uint32_t seq) {
+    Segment segment;
+    segment.seq = seq;
+    segment.size = file.size();
+    BlockHeader header;
+    bool first = true;
+    while(file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) && header.isValid()) {
+      if(first) {
+        segment.first = header.firstTime;
+        segment.coarse = header.step > 60;
+        first = false;
+      }
+      segment.last = header.lastTime;
+      file.seek(file.position() + header.payloadBytes);
+    }
+    if(first) return; // Пустой или поврежденный файл
+    if(segment.last > lastAppend) lastAppend = segment.last;
+    insertSegment(segment);
+  }
+
+  // Таблица упорядочена по номеру сегмента; при переполнении теряется самый старый
+  void insertSegment(const Segment& segment) {
+    uint8_t pos = segmentCount;
+    while(pos > 0 && segments[pos - 1].seq > segment.seq) {
+      pos--;
+    }
+    if(segmentCount == LOG_MAX_SEGMENTS) {
+      if(pos == 0) return;
+      removeSegment(0);
+      pos--;
+    }
+    for(uint8_t i = segmentCount; i > pos; i--) {
+      segments[i] = segments[i - 1];
+    }
+    segments[pos] = segment;
+    segmentCount++;
+  }
+
+  // .tmp - ужатая копия сегмента до замены исходного
+  static String segmentPath(uint32_t seq, const char* extension = "seg") {
+    char path[24];
+    snprintf(path, sizeof(path), "%s/%08lu.%s", LOG_DIR, (unsigned long)seq, extension);
+    return String(path);
+  }
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Температура в фиксированной точке: сотые доли градуса в int16
+// (-327.68..327.67 °C). Пороги задаются на этапе компиляции через degreesC(),
+// сравнения - целочисленные, форматирование - без printf и float.
+typedef int16_t TempCenti;
+
+// degreesC(75) = 75.00 °C, degreesC(0, 50) = 0.50 °C
+constexpr TempCenti degreesC(int degrees, int hundredths = 0) {
+  return degrees * 100 + (degrees < 0 ? -hundredths : hundredths);
+}
+
+// Сырое значение DS18B20 (1/128 °C) -> сотые доли с округлением
+inline TempCenti centiFromRaw(int32_t raw) {
+  int32_t scaled = raw * 100;
+  return (scaled + (scaled >= 0 ? 64 : -64)) / 128;
+}
+
+// Значение в сотых -> "23.5", "-0.50", "24" (decimals 0..2, округление от нуля).
+// plus - знак "+" у положительных (для скорости роста). Возвращает длину строки.
+inline size_t formatTemp(char* out, size_t size, int32_t value,
+                         uint8_t decimals = 1, bool plus = false) {
+  if(size == 0) return 0;
+  if(decimals > 2) decimals = 2;
+  static const uint8_t divisors[] = {100, 10, 1};
+  uint32_t divisor = divisors[decimals];
+  uint32_t scale = 100 / divisor;
+
+  bool negative = value < 0;
+  uint32_t magnitude = negative ? -(uint32_t)value : (uint32_t)value;
+  magnitude = (magnitude + divisor / 2) / divisor;
+  uint32_t whole = magnitude / scale;
+  uint32_t fraction = magnitude % scale;
+
+  char buf[16];
+  uint8_t pos = sizeof(buf);
+  buf[--pos] = '\0';
+  for(uint8_t i = 0; i < decimals; i++) {
+    buf[--pos] = '0' + fraction % 10;
+    fraction /= 10;
+  }
+  if(decimals > 0) buf[--pos] = '.';
+  do {
+    buf[--pos] = '0' + whole % 10;
+    whole /= 10;
+  } while(whole > 0);
+  if(negative && magnitude != 0) {
+    buf[--pos] = '-';
+  } else if(plus) {
+    buf[--pos] = '+';
+  }
+
+  size_t length = sizeof(buf) - 1 - pos;
+  if(length >= size) length = size - 1;
+  for(size_t i = 0; i < length; i++) {
+    out[i] = buf[pos + i];
+  }
+  out[length] = '\0';
+  return length;
+}
+
+// "75", "-0.5", "23.45" -> сотые. Не больше двух знаков после точки,
+// в пределах TempCenti. false - строка не число или вне диапазона.
+inline bool parseTemp(const char* text, TempCenti& out) {
+  bool negative = *text == '-';
+  if(negative) text++;
+  if(*text < '0' || *text > '9') return false;
+  int32_t value = 0;
+  for(; *text >= '0' && *text <= '9'; text++) {
+    value = value * 10 + (*text - '0');
+    if(value > 327) return false;
+  }
+  value *= 100;
+  if(*text == '.') {
+    text++;
+    int32_t scale = 10;
+    for(; *text >= '0' && *text <= '9' && scale > 0; text++, scale /= 10) {
+      value += (*text - '0') * scale;
+    }
+  }
+  if(*text != '\0' || value > 32767) return false;
+  out = negative ? -value : value;
+  return true;
+}
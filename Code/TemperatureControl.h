@@ -2,107 +2,599 @@
 #include <OneWire.h>
 #include <DallasTemperature.h>
 #include <Preferences.h>
+#include <atomic>
 #include "RelayController.h"
+#include "SlopeEstimator.h"
 #include "Pins.h"
 
 class TemperatureControl {
 public:
-  TemperatureControl(RelayController& relay) : 
-    relay(relay), 
+  // Режим опроса датчика: разрядность АЦП и период выборки
+  enum SamplingMode : uint8_t {
+    SAMPLING_SLOW,   // 9 бит, SENSOR_SLOW_INTERVAL
+    SAMPLING_NORMAL, // 11 бит, SENSOR_UPDATE_INTERVAL
+    SAMPLING_FAST    // 12 бит, SENSOR_FAST_INTERVAL
+  };
+
+  // Состояние одного датчика на шине TEMP_PIN
+  struct Sensor {
+    DeviceAddress address = {0};
+    TempCenti offset = 0;          // Калибровка
+    TempCenti highThreshold = TEMP_HIGH_THRESHOLD;
+    TempCenti lowThreshold = TEMP_LOW_THRESHOLD;
+    bool protects = true;          // Участвует в защите от перегрева
+    TempCenti raw = 0;
+    TempCenti temperature = 0;     // С калибровкой
+    unsigned long sampleTime = 0;  // 0 - выборок еще не было
+    bool overheated = false;
+    bool failed = false;
+    uint8_t failures = 0;          // Ошибок чтения подряд
+    bool converting = false;
+    unsigned long readyAt = 0;     // Окончание текущей конвертации
+    unsigned long nextRequest = 0;
+    unsigned long conversionTime = 750;
+    SamplingMode mode = SAMPLING_NORMAL;
+    unsigned long period = SENSOR_UPDATE_INTERVAL;
+    int32_t riseRate = 0;          // Скорость роста по окну SLOPE_WINDOW, сотые °C/мин
+    int32_t predictedMs = -1;      // Прогноз достижения порога, -1 - не растет
+    SlopeEstimator<SLOPE_WINDOW> slope;
+    uint32_t conversions = 0;
+    uint32_t errors = 0;
+  };
+
+  typedef void (*WakeCallback)();
+
+  TemperatureControl(RelayController& relay) :
+    relay(relay),
     oneWire(TEMP_PIN),
-    sensors(&oneWire) 
+    sensors(&oneWire)
   {}
 
   void init() {
-    sensors.begin();
-    if(sensors.getDeviceCount() == 0) {
+    // Запрос конвертации не ждет ее окончания - результат читается отдельным шагом
+    sensors.setWaitForConversion(false);
+    // ROM-адреса определяются один раз: дальше датчики читаются по адресу без поиска на шине
+    discoverSensors();
+    if(sensorCount == 0) {
       Serial.println("No temperature sensors!");
       relay.emergencyShutdown();
     }
     loadCalibration();
   }
 
-  void update() {
-		static unsigned long lastUpdate = 0;
-		if(millis() - lastUpdate >= SENSOR_UPDATE_INTERVAL) {
-				sensors.requestTemperatures();
-				float rawTemp = sensors.getTempCByIndex(0);
-				
-				// Проверка ошибок
-				if(rawTemp == DEVICE_DISCONNECTED_C) {
-						relay.emergencyShutdown();
-						Serial.println("Sensor error!");
-						return;
-				}
-				
-				currentTemp = rawTemp + calibrationOffset;
+  // Один шаг конвейера "запрос -> чтение". Никогда не ждет датчик.
+  // За вызов обслуживается не больше одного датчика, поэтому время шага
+  // не растет с их числом. Возвращает через сколько мс вызвать снова.
+  // Это единственное место, где идет обмен по шине OneWire.
+  unsigned long update() {
+		if(horizonDirty.exchange(false)) {
+				saveHorizon();
+		}
+		applySensorRequests();
+		if(sensorCount == 0) {
+				// Датчик мог быть подключен после старта
+				discoverSensors();
+				if(sensorCount == 0) return SENSOR_UPDATE_INTERVAL;
+				loadCalibration();
+		}
+
+		uint8_t index = nextDueSensor();
+		Sensor& sensor = sensorTable[index];
+		if((long)(millis() - dueTime(sensor)) < 0) {
+				return dueTime(sensor) - millis();
+		}
+
+		if(!sensor.converting) {
+				sensors.requestTemperaturesByAddress(sensor.address);
+				sensor.converting = true;
+				sensor.readyAt = millis() + sensor.conversionTime;
+				sensor.nextRequest = millis() + sensor.period;
+				sensor.conversions++;
+				conversions++;
+		} else {
+				sensor.converting = false;
+				readSensor(sensor);
 				checkProtection();
-				lastUpdate = millis();
+				updateSampling(sensor);
 		}
+
+		long wait = (long)(dueTime(sensorTable[nextDueSensor()]) - millis());
+		return wait > 0 ? wait : 0;
   }
 
+  // Прямые изменения настроек - только из задачи управления, остальным - request*()
   void resetCalibration() {
-    calibrationOffset = 0.0;
+    for(uint8_t i = 0; i < sensorCount; i++) {
+      sensorTable[i].offset = 0;
+      sensorTable[i].temperature = sensorTable[i].raw;
+    }
     saveCalibration();
   }
 
-  float getRawTemperature() { 
-    return sensors.getTempCByIndex(0);
+  // Все геттеры возвращают последние выборки, шину не трогают.
+  // Без номера датчика - самый горячий из участвующих в защите.
+  TempCenti getRawTemperature() const {
+    return sensorCount ? sensorTable[hottest].raw : 0;
   }
 
-
-  float getTemperature() { // С калибровкой
-    return getRawTemperature() + calibrationOffset;
-  }
-
-	void setCalibration(float offset) {
-	  calibrationOffset = offset;
+	void setCalibration(TempCenti offset, uint8_t index = 0) {
+	  if(index >= sensorCount) return;
+	  sensorTable[index].offset = offset;
+	  sensorTable[index].temperature = sensorTable[index].raw + offset;
 	  saveCalibration();
 	}
-	
-	float getCalibrationOffset() const {
-	  return calibrationOffset;
+
+	TempCenti getCalibrationOffset(uint8_t index = 0) const {
+	  return index < sensorCount ? sensorTable[index].offset : 0;
 	}
-  
-	
 
-  float getTemperature() const { return currentTemp; }
+  // Пороги и участие датчика в защите (например, датчик воздуха - только для информации)
+  void setSensorProtection(uint8_t index, TempCenti high, TempCenti low, bool protects) {
+    if(index >= sensorCount || low >= high) return;
+    sensorTable[index].highThreshold = high;
+    sensorTable[index].lowThreshold = low;
+    sensorTable[index].protects = protects;
+    saveCalibration();
+    checkProtection();
+  }
+
+  // Изменения из других задач (веб, UI): запрос применяется и сохраняется
+  // задачей управления, которую будит onWake. false - неверные пороги или номер.
+  bool requestSensorProtection(uint8_t index, TempCenti high, TempCenti low, bool protects) {
+    if(index >= MAX_TEMP_SENSORS || low >= high) return false;
+    portENTER_CRITICAL(&requestLock);
+    SensorRequest& request = sensorRequests[index];
+    request.high = high;
+    request.low = low;
+    request.protects = protects;
+    request.protectionPending = true;
+    portEXIT_CRITICAL(&requestLock);
+    if(wakeCallback) wakeCallback();
+    return true;
+  }
+
+  void requestCalibration(TempCenti offset, uint8_t index = 0) {
+    if(index >= MAX_TEMP_SENSORS) return;
+    portENTER_CRITICAL(&requestLock);
+    sensorRequests[index].offset = offset;
+    sensorRequests[index].offsetPending = true;
+    portEXIT_CRITICAL(&requestLock);
+    if(wakeCallback) wakeCallback();
+  }
+
+  // Сброс отменяет еще не примененные смещения
+  void requestCalibrationReset() {
+    portENTER_CRITICAL(&requestLock);
+    for(uint8_t i = 0; i < MAX_TEMP_SENSORS; i++) sensorRequests[i].offsetPending = false;
+    resetPending = true;
+    portEXIT_CRITICAL(&requestLock);
+    if(wakeCallback) wakeCallback();
+  }
+
+  // Пробуждение задачи управления после запросов из других задач
+  void setWakeCallback(WakeCallback onWake) {
+    wakeCallback = onWake;
+  }
+
+  // Горизонт упреждающего отключения, мс (0 - только по порогу).
+  // Можно вызывать из сетевой задачи: сохраняется в NVS задачей управления.
+  void setPredictHorizon(uint32_t horizonMs) {
+    predictHorizonMs.store(horizonMs);
+    horizonDirty.store(true);
+  }
+
+  uint32_t getPredictHorizon() const { return predictHorizonMs.load(); }
+
+  int32_t getSlope() const { return sensorCount ? sensorTable[hottest].riseRate : 0; }
+  int32_t getPredictedCrossing() const { return sensorCount ? sensorTable[hottest].predictedMs : -1; }
+  uint32_t getPredictiveTrips() const { return predictiveTrips; }
+
+  TempCenti getTemperature() const { return sensorCount ? sensorTable[hottest].temperature : 0; }
   bool isOverheated() const { return overheatStatus; }
-  float getCalibration() const { return calibrationOffset; }
+  TempCenti getCalibration() const { return getCalibrationOffset(hottest); }
+
+  uint8_t getSensorCount() const { return sensorCount; }
+  uint8_t getHottestSensor() const { return hottest; }
+
+  const Sensor& getSensor(uint8_t index) const {
+    return sensorTable[index < sensorCount ? index : 0];
+  }
+
+  // Время последней успешной выборки (millis), 0 - выборок еще не было
+  unsigned long getSampleTime() const { return sensorCount ? sensorTable[hottest].sampleTime : 0; }
+
+  unsigned long getSampleAge() const {
+    unsigned long sampleTime = getSampleTime();
+    return sampleTime == 0 ? ULONG_MAX : millis() - sampleTime;
+  }
+
+  uint32_t getConversionCount() const { return conversions; }
+  uint32_t getModeSwitches() const { return modeSwitches; }
+  uint32_t getReadErrors() const { return readErrors; }
+  uint32_t getSensorResets() const { return sensorResets; }
 
 private:
+  static constexpr uint8_t STORAGE_VERSION = 2;
+  // Метка в TH/TL scratchpad: 90 °C / -91 °C, в EEPROM датчика не копируется
+  static constexpr uint8_t SCRATCH_MARK_TH = 0x5A;
+  static constexpr uint8_t SCRATCH_MARK_TL = 0xA5;
+
+  struct StoredSensor {
+    uint8_t version = 0;
+    DeviceAddress address = {0};
+    TempCenti offset = 0;
+    TempCenti highThreshold = TEMP_HIGH_THRESHOLD;
+    TempCenti lowThreshold = TEMP_LOW_THRESHOLD;
+    bool protects = true;
+  };
+
+  // Версия 1: значения во float
+  struct StoredSensorV1 {
+    uint8_t version = 0;
+    DeviceAddress address = {0};
+    float offset = 0.0;
+    float highThreshold = 75.0;
+    float lowThreshold = 50.0;
+    bool protects = true;
+  };
+
+  struct SensorRequest {
+    TempCenti high = 0;
+    TempCenti low = 0;
+    bool protects = true;
+    bool protectionPending = false;
+    TempCenti offset = 0;
+    bool offsetPending = false;
+  };
+
   RelayController& relay;
   OneWire oneWire;
   DallasTemperature sensors;
   Preferences prefs;
-  float calibrationOffset = 0.0;
-  float currentTemp = 0.0;
+  Sensor sensorTable[MAX_TEMP_SENSORS];
+  uint8_t sensorCount = 0;
+  uint8_t hottest = 0;
+  uint32_t conversions = 0;
+  uint32_t readErrors = 0;
+  uint32_t modeSwitches = 0;
+  uint32_t sensorResets = 0;
+  uint32_t predictiveTrips = 0;
   bool overheatStatus = false;
+  std::atomic<uint32_t> predictHorizonMs{OVERHEAT_PREDICT_HORIZON};
+  std::atomic<bool> horizonDirty{false};
+  portMUX_TYPE requestLock = portMUX_INITIALIZER_UNLOCKED;
+  SensorRequest sensorRequests[MAX_TEMP_SENSORS];
+  bool resetPending = false;
+  WakeCallback wakeCallback = nullptr;
+
+  void applySensorRequests() {
+    portENTER_CRITICAL(&requestLock);
+    bool reset = resetPending;
+    resetPending = false;
+    portEXIT_CRITICAL(&requestLock);
+    if(reset) resetCalibration();
+
+    for(uint8_t i = 0; i < MAX_TEMP_SENSORS; i++) {
+      portENTER_CRITICAL(&requestLock);
+      SensorRequest request = sensorRequests[i];
+      sensorRequests[i].protectionPending = false;
+      sensorRequests[i].offsetPending = false;
+      portEXIT_CRITICAL(&requestLock);
+      if(request.offsetPending) {
+        setCalibration(request.offset, i);
+      }
+      if(request.protectionPending) {
+        setSensorProtection(i, request.high, request.low, request.protects);
+      }
+    }
+  }
 
+  void discoverSensors() {
+    // getDeviceCount() обновляется только поиском на шине в begin()
+    sensors.begin();
+    sensorCount = 0;
+    uint8_t found = sensors.getDeviceCount();
+    for(uint8_t i = 0; i < found && sensorCount < MAX_TEMP_SENSORS; i++) {
+      Sensor& sensor = sensorTable[sensorCount];
+      sensor = Sensor();
+      if(!sensors.getAddress(sensor.address, i)) continue;
+      applyMode(sensor, SAMPLING_NORMAL);
+      sensorCount++;
+    }
+    // Конвертации разнесены по периоду, чтобы датчики не опрашивались пачкой
+    unsigned long now = millis();
+    for(uint8_t i = 0; i < sensorCount; i++) {
+      sensorTable[i].nextRequest = now + i * (SENSOR_UPDATE_INTERVAL / sensorCount);
+    }
+    hottest = 0;
+  }
+
+  static unsigned long dueTime(const Sensor& sensor) {
+    return sensor.converting ? sensor.readyAt : sensor.nextRequest;
+  }
+
+  uint8_t nextDueSensor() const {
+    uint8_t best = 0;
+    unsigned long now = millis();
+    for(uint8_t i = 1; i < sensorCount; i++) {
+      if((long)(dueTime(sensorTable[i]) - now) < (long)(dueTime(sensorTable[best]) - now)) {
+        best = i;
+      }
+    }
+    return best;
+  }
+
+  void readSensor(Sensor& sensor) {
+		uint8_t scratchPad[9];
+		bool connected = sensors.isConnected(sensor.address, scratchPad);
+		if(connected && !hasOwnConfig(sensor, scratchPad)) {
+				// Датчик перезапустился: в scratchpad значения из его EEPROM (обычно 12 бит)
+				// и 85 °C до первой конвертации. Выборку отбрасываем, режим пишем заново.
+				sensorResets++;
+				applyMode(sensor, sensor.mode);
+				sensor.nextRequest = millis();
+				return;
+		}
+
+		// Проверка ошибок
+		if(!connected) {
+				sensor.errors++;
+				readErrors++;
+				if(sensor.failures < UINT8_MAX) sensor.failures++;
+				sensor.failed = true;
+				sensor.slope.clear();
+				sensor.riseRate = 0;
+				sensor.predictedMs = -1;
+				if(sensor.protects) {
+						relay.emergencyShutdown();
+						Serial.println("Sensor error!");
+				}
+				return;
+		}
+		// Сырое значение в 1/128 °C: без перевода во float
+		int32_t rawValue = (int32_t)(int16_t)((scratchPad[1] << 8) | scratchPad[0]) * 8;
+		TempCenti rawTemp = centiFromRaw(rawValue);
+		TempCenti temperature = rawTemp + sensor.offset;
+		unsigned long now = millis();
+		// Наклон по окну выборок гасит скачки на шаг квантования 0.5 °C при 9 битах
+		sensor.slope.push(now, temperature);
+		sensor.riseRate = sensor.slope.slopePerMinute();
+		sensor.predictedMs = sensor.slope.timeToReachMs(temperature, sensor.highThreshold);
+		sensor.failures = 0;
+		sensor.failed = false;
+		sensor.raw = rawTemp;
+		sensor.temperature = temperature;
+		sensor.sampleTime = now;
+  }
+
+  // Выбор режима по запасу до порога и скорости роста.
+  // Переход в более медленный режим - только с запасом SENSOR_MODE_HYSTERESIS.
+  void updateSampling(Sensor& sensor) {
+    SamplingMode mode = SAMPLING_NORMAL;
+    if(!sensor.failed && sensor.sampleTime != 0) {
+      int16_t margin = sensor.highThreshold - sensor.temperature;
+      int16_t slack = 0;
+      if(sensor.mode == SAMPLING_FAST) slack = SENSOR_MODE_HYSTERESIS;
+      if(sensor.overheated || margin < SENSOR_NEAR_MARGIN + slack ||
+         sensor.riseRate >= SENSOR_FAST_RISE) {
+        mode = SAMPLING_FAST;
+      } else {
+        slack = (sensor.mode == SAMPLING_SLOW) ? 0 : SENSOR_MODE_HYSTERESIS;
+        if(margin > SENSOR_FAR_MARGIN + slack && sensor.riseRate < SENSOR_SLOW_RISE) {
+          mode = SAMPLING_SLOW;
+        }
+      }
+    }
+    if(mode != sensor.mode) {
+      applyMode(sensor, mode);
+      modeSwitches++;
+    }
+    // Приблизить следующую выборку, если новый период короче
+    unsigned long next = sensor.sampleTime + sensor.period;
+    if((long)(sensor.nextRequest - next) > 0) {
+      sensor.nextRequest = next;
+    }
+  }
+
+  static uint8_t modeBits(SamplingMode mode) {
+    static const uint8_t bits[] = {9, 11, 12};
+    return bits[mode];
+  }
+
+  void applyMode(Sensor& sensor, SamplingMode mode) {
+    static const unsigned long periods[] = {SENSOR_SLOW_INTERVAL, SENSOR_UPDATE_INTERVAL, SENSOR_FAST_INTERVAL};
+    sensor.mode = mode;
+    sensor.period = periods[mode];
+    sensor.conversionTime = sensors.millisToWaitForConversion(modeBits(mode));
+    writeResolution(sensor.address, modeBits(mode));
+  }
+
+  // Разрядность пишется только в scratchpad, без копирования в EEPROM датчика:
+  // переключения частые, а COPYSCRATCH блокирует шину и изнашивает EEPROM.
+  // Поэтому после сброса питания датчик забывает режим; чтобы это заметить,
+  // в неиспользуемые TH/TL пишется метка, которой нет в EEPROM (см. hasOwnConfig).
+  void writeResolution(const uint8_t* address, uint8_t bits) {
+    oneWire.reset();
+    oneWire.select(address);
+    oneWire.write(0x4E);                        // WRITE SCRATCHPAD
+    oneWire.write(SCRATCH_MARK_TH);             // TH (аварийные пороги датчика не используются)
+    oneWire.write(SCRATCH_MARK_TL);             // TL
+    oneWire.write(configByte(bits));            // Регистр конфигурации
+    oneWire.reset();
+  }
+
+  static uint8_t configByte(uint8_t bits) {
+    return ((bits - 9) << 5) | 0x1F;
+  }
+
+  // Scratchpad содержит записанные нами метку и разрядность, то есть
+  // конвертация шла в ожидаемом режиме и conversionTime ей соответствует
+  static bool hasOwnConfig(const Sensor& sensor, const uint8_t* scratchPad) {
+    return scratchPad[2] == SCRATCH_MARK_TH && scratchPad[3] == SCRATCH_MARK_TL &&
+           scratchPad[4] == configByte(modeBits(sensor.mode));
+  }
+
+  // Защита по самому горячему (ближе всех к своему порогу) датчику из участвующих
   void checkProtection() {
+    bool anyOverheated = false;
+    bool allCooled = true;
+    bool tripped = false;
+    int16_t worstMargin = 0;
+    bool haveHottest = false;
 
-    if(relay.isBlocked() && currentTemp <= TEMP_LOW_THRESHOLD) {
+    for(uint8_t i = 0; i < sensorCount; i++) {
+      Sensor& sensor = sensorTable[i];
+      if(!sensor.protects) continue;
+      if(sensor.failed || sensor.sampleTime == 0) {
+        allCooled = false;
+        continue;
+      }
+
+      uint32_t horizon = predictHorizonMs.load();
+      if(sensor.temperature >= sensor.highThreshold && !sensor.overheated) {
+        sensor.overheated = true;
+        tripped = true;
+      }
+      else if(!sensor.overheated && horizon > 0 &&
+              sensor.predictedMs >= 0 && (uint32_t)sensor.predictedMs <= horizon) {
+        // Порог будет пройден раньше, чем датчик успеет его показать
+        sensor.overheated = true;
+        tripped = true;
+        predictiveTrips++;
+      }
+      else if(sensor.temperature <= sensor.lowThreshold && sensor.overheated) {
+        sensor.overheated = false;
+      }
+      anyOverheated |= sensor.overheated;
+      allCooled &= sensor.temperature <= sensor.lowThreshold;
+
+      int16_t margin = sensor.highThreshold - sensor.temperature;
+      if(!haveHottest || margin < worstMargin) {
+        worstMargin = margin;
+        hottest = i;
+        haveHottest = true;
+      }
+    }
+
+    if(relay.isBlocked() && allCooled) {
       relay.tryReset();
     }
-    
-    if(currentTemp >= TEMP_HIGH_THRESHOLD && !overheatStatus) {
+
+    if(tripped) {
       relay.emergencyShutdown();
-      overheatStatus = true;
-    }
-    else if(currentTemp <= TEMP_LOW_THRESHOLD && overheatStatus) {
-      overheatStatus = false;
     }
+    overheatStatus = anyOverheated;
   }
 
   void loadCalibration() {
     prefs.begin("temp", true);
-    calibrationOffset = prefs.getFloat("calib", 0.0);
+    // Настройки привязаны к ROM-адресу: порядок датчиков на шине может меняться
+    for(uint8_t slot = 0; slot < MAX_TEMP_SENSORS; slot++) {
+      StoredSensor stored;
+      if(!readStoredSensor(slot, stored)) continue;
+      for(uint8_t i = 0; i < sensorCount; i++) {
+        Sensor& sensor = sensorTable[i];
+        if(memcmp(sensor.address, stored.address, sizeof(DeviceAddress)) != 0) continue;
+        sensor.offset = stored.offset;
+        sensor.highThreshold = stored.highThreshold;
+        sensor.lowThreshold = stored.lowThreshold;
+        sensor.protects = stored.protects;
+      }
+    }
+    // Старый формат: одно смещение для единственного датчика
+    if(sensorCount > 0 && !prefs.isKey(getSensorKey(0).c_str())) {
+      sensorTable[0].offset = lroundf(prefs.getFloat("calib", 0.0) * 100);
+    }
+    predictHorizonMs.store(prefs.getUInt("horizon", OVERHEAT_PREDICT_HORIZON));
+    prefs.end();
+  }
+
+  // Запись текущей версии или перевод float-записи версии 1 в сотые
+  bool readStoredSensor(uint8_t slot, StoredSensor& stored) {
+    String key = getSensorKey(slot);
+    size_t length = prefs.getBytesLength(key.c_str());
+    if(length == sizeof(StoredSensor)) {
+      prefs.getBytes(key.c_str(), &stored, sizeof(stored));
+      return stored.version == STORAGE_VERSION;
+    }
+    StoredSensorV1 legacy;
+    if(length != sizeof(legacy) ||
+       prefs.getBytes(key.c_str(), &legacy, sizeof(legacy)) != sizeof(legacy) ||
+       legacy.version != 1) {
+      return false;
+    }
+    memcpy(stored.address, legacy.address, sizeof(DeviceAddress));
+    stored.offset = lroundf(legacy.offset * 100);
+    stored.highThreshold = lroundf(legacy.highThreshold * 100);
+    stored.lowThreshold = lroundf(legacy.lowThreshold * 100);
+    stored.protects = legacy.protects;
+    return true;
+  }
+
+  void saveHorizon() {
+    prefs.begin("temp", false);
+    prefs.putUInt("horizon", predictHorizonMs.load());
     prefs.end();
   }
 
+  // Запись ищется по ROM-адресу: слот датчика перезаписывается на месте, новому
+  // датчику отдается свободный слот. Записи датчиков, которых сейчас нет на шине
+  // (плохой контакт, не ответил при поиске), сохраняются. Удаляются только
+  // повторы адреса - при загрузке они перебили бы актуальную запись.
   void saveCalibration() {
+    if(sensorCount == 0) return; // Пустая шина не затирает сохраненные настройки
     prefs.begin("temp", false);
-    prefs.putFloat("calib", calibrationOffset);
+    StoredSensor slots[MAX_TEMP_SENSORS];
+    bool used[MAX_TEMP_SENSORS];
+    for(uint8_t slot = 0; slot < MAX_TEMP_SENSORS; slot++) {
+      used[slot] = readStoredSensor(slot, slots[slot]);
+    }
+
+    for(uint8_t i = 0; i < sensorCount; i++) {
+      const Sensor& sensor = sensorTable[i];
+      int8_t target = -1;
+      for(uint8_t slot = 0; slot < MAX_TEMP_SENSORS; slot++) {
+        if(!used[slot] || memcmp(slots[slot].address, sensor.address, sizeof(DeviceAddress)) != 0) continue;
+        if(target < 0) {
+          target = slot;
+        } else {
+          prefs.remove(getSensorKey(slot).c_str());
+          used[slot] = false;
+        }
+      }
+      if(target < 0) target = freeSlot(slots, used);
+
+      StoredSensor& stored = slots[target];
+      stored = StoredSensor();
+      stored.version = STORAGE_VERSION;
+      memcpy(stored.address, sensor.address, sizeof(DeviceAddress));
+      stored.offset = sensor.offset;
+      stored.highThreshold = sensor.highThreshold;
+      stored.lowThreshold = sensor.lowThreshold;
+      stored.protects = sensor.protects;
+      used[target] = true;
+      prefs.putBytes(getSensorKey(target).c_str(), &stored, sizeof(stored));
+    }
     prefs.end();
   }
-};
\ No newline at end of file
+
+  // Свободный слот, а если все заняты - первый слот датчика, которого нет на шине.
+  // Датчиков на шине не больше MAX_TEMP_SENSORS, так что такой слот есть.
+  uint8_t freeSlot(const StoredSensor* slots, const bool* used) const {
+    for(uint8_t slot = 0; slot < MAX_TEMP_SENSORS; slot++) {
+      if(!used[slot]) return slot;
+    }
+    for(uint8_t slot = 0; slot < MAX_TEMP_SENSORS; slot++) {
+      bool present = false;
+      for(uint8_t i = 0; i < sensorCount && !present; i++) {
+        present = memcmp(slots[slot].address, sensorTable[i].address, sizeof(DeviceAddress)) == 0;
+      }
+      if(!present) return slot;
+    }
+    return 0;
+  }
+
+  String getSensorKey(uint8_t slot) const {
+    return "s" + String(slot);
+  }
+};
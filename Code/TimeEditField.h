@@ -12,6 +12,7 @@ enum TimeEditField {
 
 enum ScheduleEditField {
 	SCHEDULE_EDIT_DAY,
+	SCHEDULE_EDIT_INTERVAL,
 	SCHEDULE_EDIT_START,
 	SCHEDULE_EDIT_STOP,
 	SCHEDULE_EDIT_ACCELERATION
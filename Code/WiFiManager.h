@@ -1,10 +1,15 @@
 #pragma once
 
 #include <WiFi.h>
-#include <WebServer.h>
 #include <Preferences.h>
+#include <atomic>
 #include "RTCTimeManager.h"
 #include "ScheduleManager.h"
+#include "TemperatureControl.h"
+#include "SharedState.h"
+#include "TelemetryHistory.h"
+#include "TelemetryLog.h"
+#include "HttpServer.h"
 
 class WiFiManager {
 public:
@@ -15,8 +20,11 @@ public:
     AP_MODE
   };
   
-  WiFiManager(RTCTimeManager& tm, ScheduleManager& sm) 
-  : server(80), timeManager(tm), scheduleManager(sm) {
+  WiFiManager(RTCTimeManager& tm, ScheduleManager& sm,
+              TemperatureControl& tc, const SharedState& ss,
+              const TelemetryHistory& th, TelemetryLog& tl) 
+  : server(80), timeManager(tm), scheduleManager(sm), tempControl(tc),
+    sharedState(ss), history(th), telemetryLog(tl) {
     apSSID = "SmartPlug_" + String(ESP.getEfuseMac(), HEX);
   }
   
@@ -27,67 +35,309 @@ public:
     server.on("/reconfigure", [this]() { handleReconfigure(); });
   }
   
+  // Вызывается сетевой задачей, когда waitForEvents() дождался событий сокетов
+  // (или истек таймаут): все готовые соединения обслуживаются без ожидания
   void handleClient() {
-    server.handleClient();
+    if(resetRequested.exchange(false)) {
+      performReset();
+    }
+    server.poll();
+    if(restartPending && (!server.isSending() || millis() - restartRequestedAt > RESTART_RESPONSE_TIMEOUT)) {
+      performRestart();
+    }
     if(state == WiFiState::CONNECTING && millis() - lastCheck > 10000) {
       checkConnection();
     }
   }
   
+  // Ожидание событий веб-сервера - в отдельной задаче, не одновременно с handleClient()
+  void waitForEvents(unsigned long timeoutMs) {
+    server.waitForEvents(timeoutMs);
+  }
+
+  const HttpServer::Stats& getWebStats() const {
+    return server.getStats();
+  }
+
+  // Вызывается из UI: сброс выполняет сетевая задача в handleClient()
   void resetCredentials() {
-    prefs.begin("wifi", false);
-    prefs.remove("ssid");
-    prefs.remove("pass");
-    prefs.end();
-    WiFi.disconnect();
-    state = WiFiState::DISCONNECTED; // Добавить эту строку
-    startAPMode(); // Добавить переход в режим AP
+    resetRequested.store(true);
   }
-  
+
+  // d<N>  - список интервалов дня: [["06:00","09:00"],["17:00","23:00"]]
+  // d<N>s/d<N>e - первый интервал (прежний формат)
   void handleScheduleGet() {
-	String json = "{";
+	String json = "{\"max\":" + String(ScheduleManager::MAX_INTERVALS);
 		for(int i = 0; i < 7; i++) {
-			json += "\"d" + String(i) + "s\":\"" + formatTime(scheduleManager.weeklySchedule[i].start) + "\",";
-			json += "\"d" + String(i) + "e\":\"" + formatTime(scheduleManager.weeklySchedule[i].end) + "\"";
-			if(i < 6) json += ",";
+			ScheduleManager::DaySchedule day = scheduleManager.getDay(i);
+			String key = "\"d" + String(i);
+			json += "," + key + "\":[";
+			for(uint8_t j = 0; j < day.count; j++) {
+				if(j > 0) json += ",";
+				json += "[\"" + formatTime(day.intervals[j].start) + "\",\"" + formatTime(day.intervals[j].end) + "\"]";
+			}
+			json += "]";
+			uint32_t start = day.count > 0 ? day.intervals[0].start : 0;
+			uint32_t end = day.count > 0 ? day.intervals[0].end : 0;
+			json += "," + key + "s\":\"" + formatTime(start) + "\",";
+			json += key + "e\":\"" + formatTime(end) + "\"";
 		}
 		json += "}";
 		server.send(200, "application/json", json);
   }
 
+  // Конец суток - "24:00", чтобы весь день не превращался в пустой 00:00-00:00
   String formatTime(uint32_t seconds) {
+	  if(seconds != ScheduleManager::SECONDS_PER_DAY) seconds %= ScheduleManager::SECONDS_PER_DAY;
 	  uint8_t hours = seconds / 3600;
 	  uint8_t minutes = (seconds % 3600) / 60;
 	  return (hours < 10 ? "0" : "") + String(hours) + ":" + 
 	  (minutes < 10 ? "0" : "") + String(minutes);
   }
 
+  // Принимает d<N>=ЧЧ:ММ-ЧЧ:ММ,ЧЧ:ММ-ЧЧ:ММ (пустое значение - день выключен)
+  // либо прежние поля d<N>s/d<N>e. Расписание применяется только целиком.
   void handleSchedulePost() {
+	  ScheduleManager::DaySchedule days[7];
 	  bool success = true;
-	    for(int i = 0; i < 7; i++) {
+	    for(int i = 0; i < 7 && success; i++) {
+	  	  String listKey = "d" + String(i);
+	  	  if(server.hasArg(listKey)) {
+	  	  	success = parseIntervals(server.arg(listKey), days[i]);
+	  	  	continue;
+	  	  }
+
 	  	  String startStr = server.arg("d" + String(i) + "s");
 	  	  String endStr = server.arg("d" + String(i) + "e");
 		
 	  	  uint32_t start = parseTime(startStr);
 	  	  uint32_t end = parseTime(endStr);
 		
-	  	  if(start > 86340 || end > 86340) { // Максимум 23:59
+	  	  if(start > 86340 || end > ScheduleManager::SECONDS_PER_DAY) { // Старт до 23:59, стоп до 24:00
 	  	  	success = false;
 	  	  	break;
 	  	  }
 		
-		    scheduleManager.weeklySchedule[i].start = start;
-		    scheduleManager.weeklySchedule[i].end = end;
+		    days[i].add(start, end);
 	    }
 	
 	    if(success) {
+	  	  for(int i = 0; i < 7; i++) {
+	  	  	scheduleManager.setDay(i, days[i]);
+	  	  }
 	  	  scheduleManager.save();
+	  	  scheduleManager.requestCheck();
 	  	  server.send(200, "text/plain", "OK");
 	    } else {
 	  	  server.send(400, "text/plain", "Ошибка формата времени");
 	    }
   }
 
+  bool parseIntervals(const String& list, ScheduleManager::DaySchedule& day) {
+	  int from = 0;
+	  while(from < (int)list.length()) {
+	  	int comma = list.indexOf(',', from);
+	  	String item = list.substring(from, comma == -1 ? list.length() : comma);
+	  	from = (comma == -1) ? list.length() : comma + 1;
+
+	  	int dash = item.indexOf('-');
+	  	if(dash == -1) return false;
+	  	uint32_t start = parseTime(item.substring(0, dash));
+	  	uint32_t end = parseTime(item.substring(dash + 1));
+	  	if(start > 86340 || end > ScheduleManager::SECONDS_PER_DAY) return false; // Старт до 23:59, стоп до 24:00
+	  	if(!day.add(start, end)) return false; // Больше MAX_INTERVALS
+	  }
+	  return true;
+  }
+
+  // Состояние синхронизации NTP для мониторинга
+  void handleTimeStatus() {
+    uint32_t age = timeManager.getSyncAge();
+    // String(long) обрезал бы int64 на 32-битном ESP32
+    char offset[24];
+    snprintf(offset, sizeof(offset), "%lld", (long long)timeManager.getLastNtpOffsetUs());
+    String json = "{";
+    json += "\"offset_us\":" + String(offset) + ",";
+    json += "\"rtt_us\":" + String(timeManager.getLastNtpRttUs()) + ",";
+    json += "\"age_s\":" + (age == UINT32_MAX ? String("null") : String(age)) + ",";
+    json += "\"server\":\"" + String(timeManager.getLastNtpServer()) + "\",";
+    json += "\"failures\":" + String(timeManager.getSyncFailures());
+    json += "}";
+    server.send(200, "application/json", json);
+  }
+
+  // Показания датчиков, скорость роста и прогноз достижения порога
+  void handleTemperatureGet() {
+    ControlSnapshot snapshot = sharedState.read();
+    String json = "{";
+    json += "\"t\":" + fixedToString(snapshot.temperature) + ",";
+    json += "\"overheated\":" + String(snapshot.overheated ? "true" : "false") + ",";
+    json += "\"slope\":" + fixedToString(snapshot.slope) + ",";
+    json += "\"predicted_s\":" + (snapshot.predictedMs < 0 ? String("null") : fixedToString(snapshot.predictedMs / 10, 1)) + ",";
+    json += "\"horizon_s\":" + String(tempControl.getPredictHorizon() / 1000) + ",";
+    json += "\"sensors\":[";
+    for(uint8_t i = 0; i < snapshot.sensorCount; i++) {
+      const SensorReading& sensor = snapshot.sensors[i];
+      if(i > 0) json += ",";
+      json += "{\"t\":" + fixedToString(sensor.temperature);
+      json += ",\"raw\":" + fixedToString(sensor.rawTemperature);
+      json += ",\"slope\":" + fixedToString(sensor.slope);
+      json += ",\"failed\":" + String(sensor.failed ? "true" : "false");
+      json += ",\"high\":" + fixedToString(sensor.highThreshold);
+      json += ",\"low\":" + fixedToString(sensor.lowThreshold);
+      json += ",\"protects\":" + String(sensor.protects ? "true" : "false") + "}";
+    }
+    json += "]}";
+    server.send(200, "application/json", json);
+  }
+
+  // horizon=<секунды> - горизонт упреждающего отключения (0 - выключено);
+  // sensor=<номер>&high=<°C>&low=<°C>&protects=0|1 - пороги датчика
+  // (пропущенные поля остаются прежними). Можно вместе в одном запросе.
+  void handleTemperaturePost() {
+    bool hasHorizon = server.hasArg("horizon");
+    bool hasSensor = server.hasArg("sensor");
+    if(!hasHorizon && !hasSensor) {
+      server.send(400, "text/plain", "Missing horizon or sensor");
+      return;
+    }
+    long horizon = hasHorizon ? server.arg("horizon").toInt() : 0;
+    if(horizon < 0 || horizon > 3600) {
+      server.send(400, "text/plain", "Invalid horizon");
+      return;
+    }
+    if(hasSensor && !requestSensorProtection()) return;
+    if(hasHorizon) tempControl.setPredictHorizon(horizon * 1000);
+    server.send(200, "text/plain", "OK");
+  }
+
+  // Разбор полей датчика; при ошибке ответ уже отправлен
+  bool requestSensorProtection() {
+    ControlSnapshot snapshot = sharedState.read();
+    long index = server.arg("sensor").toInt();
+    if(index < 0 || index >= snapshot.sensorCount) {
+      server.send(400, "text/plain", "Invalid sensor");
+      return false;
+    }
+    const SensorReading& sensor = snapshot.sensors[index];
+    TempCenti high = sensor.highThreshold;
+    TempCenti low = sensor.lowThreshold;
+    bool protects = sensor.protects;
+    if((server.hasArg("high") && !parseTemp(server.arg("high").c_str(), high)) ||
+       (server.hasArg("low") && !parseTemp(server.arg("low").c_str(), low))) {
+      server.send(400, "text/plain", "Invalid threshold");
+      return false;
+    }
+    if(server.hasArg("protects")) protects = server.arg("protects") != "0";
+    if(!tempControl.requestSensorProtection(index, high, low, protects)) {
+      server.send(400, "text/plain", "Low must be below high");
+      return false;
+    }
+    return true;
+  }
+
+  // История из ОЗУ в CSV: tier=s|m|h, from/to - эпоха (по умолчанию весь буфер).
+  // Ответ отдается порциями не больше HISTORY_CHUNK записей, весь диапазон в память не копируется.
+  void handleHistory() {
+    String tierArg = server.hasArg("tier") ? server.arg("tier") : String("s");
+    TelemetryHistory::Tier tier = TelemetryHistory::TIER_SECONDS;
+    if(tierArg == "m") tier = TelemetryHistory::TIER_MINUTES;
+    else if(tierArg == "h") tier = TelemetryHistory::TIER_HOURS;
+    else if(tierArg != "s") {
+      server.send(400, "text/plain", "Invalid tier");
+      return;
+    }
+    uint32_t from = server.hasArg("from") ? server.arg("from").toInt() : 0;
+    uint32_t to = server.hasArg("to") ? server.arg("to").toInt() : UINT32_MAX;
+
+    // Порции формируются по мере отправки: курсор живет в Producer
+    TelemetryHistory::Cursor cursor = history.seek(tier, from);
+    bool headerSent = false;
+    bool done = false;
+    server.sendChunked(200, "text/csv",
+        [this, tier, cursor, to, headerSent, done](char* out, size_t size) mutable -> size_t {
+      size_t length = 0;
+      if(!headerSent) {
+        headerSent = true;
+        length = snprintf(out, size, tier == TelemetryHistory::TIER_SECONDS
+                          ? "time,temp,flags\n" : "time,min,max,mean,relay_pct,flags\n");
+      }
+      // Пустая порция означает конец ответа - читаем, пока есть что отдать
+      while(!done && length == 0) {
+        uint16_t room = (size - length) / 48;
+        if(room > HISTORY_CHUNK) room = HISTORY_CHUNK;
+        uint16_t count;
+        if(tier == TelemetryHistory::TIER_SECONDS) {
+          TelemetryHistory::Sample samples[HISTORY_CHUNK];
+          count = history.readSeconds(cursor, samples, room);
+          for(uint16_t i = 0; i < count && !done; i++) {
+            if(samples[i].time > to) { done = true; break; }
+            if(!(samples[i].flags & TelemetryHistory::FLAG_VALID)) continue;
+            char temp[8];
+            formatTemp(temp, sizeof(temp), samples[i].centi, 2);
+            length += snprintf(out + length, size - length, "%lu,%s,%u\n",
+                               (unsigned long)samples[i].time, temp, samples[i].flags & 0x7F);
+          }
+        } else {
+          TelemetryHistory::Rollup rollups[HISTORY_CHUNK];
+          count = history.readRollups(tier, cursor, rollups, room);
+          for(uint16_t i = 0; i < count && !done; i++) {
+            const TelemetryHistory::Rollup& r = rollups[i];
+            if(r.time > to) { done = true; break; }
+            if(!(r.flags & TelemetryHistory::FLAG_VALID)) continue;
+            length += formatRollup(out + length, size - length, r);
+          }
+        }
+        if(count == 0) done = true;
+      }
+      return length;
+    });
+  }
+
+  // Журнал из флеша в CSV: from/to - эпоха. Каждая порция ответа - отдельный
+  // запрос к журналу с места, где закончилась предыдущая.
+  void handleLog() {
+    uint32_t from = server.hasArg("from") ? server.arg("from").toInt() : 0;
+    uint32_t to = server.hasArg("to") ? server.arg("to").toInt() : UINT32_MAX;
+
+    bool headerSent = false;
+    server.sendChunked(200, "text/csv",
+        [this, from, to, headerSent](char* out, size_t size) mutable -> size_t {
+      if(!headerSent) {
+        headerSent = true;
+        return snprintf(out, size, "time,min,max,mean,relay_pct,flags\n");
+      }
+      // Запрос продолжается с записи, следующей за последней отправленной
+      size_t length = 0;
+      uint32_t next = from;
+      telemetryLog.query(from, to, size / 48, [&](const TelemetryHistory::Rollup& entry) {
+        length += formatRollup(out + length, size - length, entry);
+        next = entry.time + 1;
+      });
+      if(next <= from) return 0; // Больше записей нет (или дошли до UINT32_MAX)
+      from = next;
+      return length;
+    });
+  }
+
+  // Строка CSV минутной/часовой записи, не длиннее 48 байт
+  static size_t formatRollup(char* out, size_t size, const TelemetryHistory::Rollup& r) {
+    char low[8], high[8], mean[8];
+    formatTemp(low, sizeof(low), r.minCenti, 2);
+    formatTemp(high, sizeof(high), r.maxCenti, 2);
+    formatTemp(mean, sizeof(mean), r.meanCenti, 2);
+    return snprintf(out, size, "%lu,%s,%s,%s,%u,%u\n",
+                    (unsigned long)r.time, low, high, mean,
+                    r.relayOnPercent, r.flags & 0x7F);
+  }
+
+  // Значение в сотых -> "23.45" для JSON
+  static String fixedToString(int32_t value, uint8_t decimals = 2) {
+    char text[16];
+    formatTemp(text, sizeof(text), value, decimals);
+    return String(text);
+  }
+
   uint32_t parseTime(String timeStr) {
 	  int colonIndex = timeStr.indexOf(':');
 	  if(colonIndex == -1) return 0;
@@ -140,12 +390,21 @@ public:
   }
   
 private:
-  WebServer server;
+  static constexpr uint8_t HISTORY_CHUNK = 32; // Записей истории на порцию ответа
+
+  HttpServer server;
   RTCTimeManager& timeManager;
   ScheduleManager& scheduleManager;
+  TemperatureControl& tempControl;
+  const SharedState& sharedState;
+  const TelemetryHistory& history;
+  TelemetryLog& telemetryLog;
   Preferences prefs;
   WiFiState state = WiFiState::DISCONNECTED;
   unsigned long lastCheck = 0;
+  std::atomic<bool> resetRequested{false};
+  bool restartPending = false;         // Только сетевая задача
+  unsigned long restartRequestedAt = 0;
   String apSSID;
   String apPass = "configure123";
   String storedSSID;
@@ -158,6 +417,22 @@ private:
     prefs.end();
   }
   
+  void performRestart() {
+    telemetryLog.flush(); // Не терять незаписанный блок журнала
+    delay(RESTART_CLOSE_DELAY);
+    ESP.restart();
+  }
+
+  void performReset() {
+    prefs.begin("wifi", false);
+    prefs.remove("ssid");
+    prefs.remove("pass");
+    prefs.end();
+    WiFi.disconnect();
+    state = WiFiState::DISCONNECTED; // Добавить эту строку
+    startAPMode(); // Добавить переход в режим AP
+  }
+  
   void beginConnection() {
     if(storedSSID.length() > 0) {
       connectToWiFi(storedSSID.c_str(), storedPass.c_str());
@@ -180,12 +455,17 @@ private:
     if (WiFi.status() == WL_CONNECTED) {
       state = WiFiState::CONNECTED;
       server.on("/", [this]() { handleRoot(); });
-      server.on("/config", HTTP_GET, [this]() { handleConfig(); });
-			server.on("/schedule", HTTP_GET, [this]() { handleScheduleGet(); });
-			server.on("/schedule", HTTP_POST, [this]() { handleSchedulePost(); });
+      server.on("/config", HttpServer::Method::GET, [this]() { handleConfig(); });
+			server.on("/schedule", HttpServer::Method::GET, [this]() { handleScheduleGet(); });
+			server.on("/schedule", HttpServer::Method::POST, [this]() { handleSchedulePost(); });
+      server.on("/time", HttpServer::Method::GET, [this]() { handleTimeStatus(); });
+      server.on("/temperature", HttpServer::Method::GET, [this]() { handleTemperatureGet(); });
+      server.on("/temperature", HttpServer::Method::POST, [this]() { handleTemperaturePost(); });
+      server.on("/history", HttpServer::Method::GET, [this]() { handleHistory(); });
+      server.on("/log", HttpServer::Method::GET, [this]() { handleLog(); });
       server.begin();
       if(timeManager.needsTimeSync()) {
-        timeManager.syncTime();
+        timeManager.requestSync();
       }
     } else {
       Serial.println("Connection Failed!");
@@ -198,7 +478,7 @@ private:
     state = WiFiState::AP_MODE;
     
     server.on("/", [this]() { handleAPRoot(); });
-    server.on("/save", HTTP_GET, [this]() { handleAPSave(); });
+    server.on("/save", HttpServer::Method::GET, [this]() { handleAPSave(); });
     server.begin();
   }
   
@@ -266,16 +546,19 @@ private:
     
     if(ssid.length() > 0) {
       saveCredentials(ssid, pass);
+      // send() только ставит ответ в очередь: перезагрузка - в handleClient(),
+      // когда ответ отправлен и соединение закрыто
+      server.closeAfterResponse();
       server.send(200, "text/plain", "Settings saved. Rebooting...");
-      delay(1000);
-      ESP.restart();
+      restartPending = true;
+      restartRequestedAt = millis();
     } else {
       server.send(400, "text/plain", "SSID cannot be empty");
     }
   }
   
   void handleSchedule() {
-    if(server.method() == HTTP_POST) {
+    if(server.method() == HttpServer::Method::POST) {
       bool success = true;
       
       for(int i = 0; i < 7; i++) {
@@ -297,8 +580,7 @@ private:
 			      server.send(200, "text/plain", "Schedule updated");
 		      }
           
-          scheduleManager.weeklySchedule[i].start = start;
-          scheduleManager.weeklySchedule[i].end = end;
+          scheduleManager.setDay(i, start, end);
         }
       }
       
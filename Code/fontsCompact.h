@@ -0,0 +1,134 @@
+#pragma once
+#include <Arduino.h>
+
+// Сгенерировано tools/fontsubset.py из fontsRus.h - не редактировать вручную.
+// Формат описан в CompactFont.h.
+//
+// ArialRus_Plain_10: 224 -> 146 glyphs (127 RLE), 3160 -> 1875 bytes (-41%)
+// ArialRus_Plain_24: 224 -> 1 glyphs (1 RLE), 11727 -> 18 bytes (-100%)
+
+const uint8_t ArialRus_Plain_10_Compact[] PROGMEM = {
+  0x0D, 0x92, 0x20, 0xE0, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B,
+  0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B,
+  0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B,
+  0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B,
+  0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B,
+  0x4C, 0x4D, 0x4E, 0x4F, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B,
+  0x5C, 0x5D, 0x5E, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0x5F, 0x60, 0x61, 0xFF, 0x62, 0x63, 0x64, 0x65, 0x66, 0xFF, 0x67, 0x68,
+  0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F, 0x70, 0xFF, 0xFF, 0xFF, 0x71, 0xFF, 0xFF, 0xFF, 0xFF,
+  0x72, 0xFF, 0xFF, 0xFF, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E,
+  0x7F, 0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0xFF, 0x8D,
+  0x8E, 0x8F, 0x90, 0x91, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x83, 0x00, 0x03, 0x03, 0x84,
+  0x00, 0x06, 0x09, 0x86, 0x00, 0x0F, 0x0A, 0x06, 0x00, 0x19, 0x0C, 0x89, 0x00, 0x25, 0x0E, 0x07,
+  0x00, 0x33, 0x01, 0x02, 0x00, 0x34, 0x05, 0x83, 0x00, 0x39, 0x05, 0x83, 0x00, 0x3E, 0x05, 0x04,
+  0x00, 0x43, 0x06, 0x86, 0x00, 0x49, 0x02, 0x83, 0x00, 0x4B, 0x03, 0x83, 0x00, 0x4E, 0x02, 0x83,
+  0x00, 0x50, 0x04, 0x83, 0x00, 0x54, 0x07, 0x86, 0x00, 0x5B, 0x05, 0x86, 0x00, 0x60, 0x0A, 0x06,
+  0x00, 0x6A, 0x0A, 0x06, 0x00, 0x74, 0x0A, 0x86, 0x00, 0x7E, 0x0A, 0x06, 0x00, 0x88, 0x0A, 0x06,
+  0x00, 0x92, 0x07, 0x86, 0x00, 0x99, 0x0A, 0x06, 0x00, 0xA3, 0x0A, 0x06, 0x00, 0xAD, 0x03, 0x83,
+  0x00, 0xB0, 0x03, 0x83, 0x00, 0xB3, 0x08, 0x86, 0x00, 0xBB, 0x09, 0x86, 0x00, 0xC4, 0x08, 0x86,
+  0x00, 0xCC, 0x09, 0x86, 0x00, 0xD5, 0x14, 0x0A, 0x00, 0xE9, 0x0B, 0x87, 0x00, 0xF4, 0x0A, 0x87,
+  0x00, 0xFE, 0x09, 0x87, 0x01, 0x07, 0x08, 0x87, 0x01, 0x0F, 0x0B, 0x87, 0x01, 0x1A, 0x07, 0x86,
+  0x01, 0x21, 0x0C, 0x88, 0x01, 0x2D, 0x07, 0x87, 0x01, 0x34, 0x02, 0x83, 0x01, 0x36, 0x05, 0x85,
+  0x01, 0x3B, 0x0A, 0x87, 0x01, 0x45, 0x07, 0x86, 0x01, 0x4C, 0x09, 0x89, 0x01, 0x55, 0x07, 0x87,
+  0x01, 0x5C, 0x09, 0x88, 0x01, 0x65, 0x09, 0x87, 0x01, 0x6E, 0x0A, 0x88, 0x01, 0x78, 0x09, 0x87,
+  0x01, 0x81, 0x0C, 0x07, 0x01, 0x8D, 0x06, 0x87, 0x01, 0x93, 0x06, 0x87, 0x01, 0x99, 0x08, 0x87,
+  0x01, 0xA1, 0x0A, 0x89, 0x01, 0xAB, 0x0B, 0x87, 0x01, 0xB6, 0x08, 0x87, 0x01, 0xBE, 0x0C, 0x06,
+  0x01, 0xCA, 0x04, 0x83, 0x01, 0xCE, 0x03, 0x83, 0x01, 0xD1, 0x03, 0x83, 0x01, 0xD4, 0x06, 0x85,
+  0x01, 0xDA, 0x07, 0x86, 0x01, 0xE1, 0x02, 0x83, 0x01, 0xE3, 0x09, 0x86, 0x01, 0xEC, 0x07, 0x86,
+  0x01, 0xF3, 0x08, 0x86, 0x01, 0xFB, 0x07, 0x86, 0x02, 0x02, 0x09, 0x86, 0x02, 0x0B, 0x04, 0x83,
+  0x02, 0x0F, 0x08, 0x86, 0x02, 0x17, 0x06, 0x86, 0x02, 0x1D, 0x03, 0x83, 0x02, 0x20, 0x03, 0x83,
+  0x02, 0x23, 0x06, 0x84, 0x02, 0x29, 0x02, 0x83, 0x02, 0x2B, 0x09, 0x89, 0x02, 0x34, 0x05, 0x86,
+  0x02, 0x39, 0x07, 0x86, 0x02, 0x40, 0x07, 0x86, 0x02, 0x47, 0x07, 0x86, 0x02, 0x4E, 0x03, 0x83,
+  0x02, 0x51, 0x08, 0x04, 0x02, 0x59, 0x05, 0x83, 0x02, 0x5E, 0x05, 0x86, 0x02, 0x63, 0x06, 0x85,
+  0x02, 0x69, 0x08, 0x87, 0x02, 0x71, 0x09, 0x85, 0x02, 0x7A, 0x06, 0x85, 0x02, 0x80, 0x0A, 0x05,
+  0x02, 0x8A, 0x05, 0x83, 0x02, 0x8F, 0x02, 0x83, 0x02, 0x91, 0x05, 0x83, 0x02, 0x96, 0x06, 0x86,
+  0x02, 0x9C, 0x0B, 0x87, 0x02, 0xA7, 0x0A, 0x87, 0x02, 0xB1, 0x0A, 0x87, 0x02, 0xBB, 0x09, 0x87,
+  0x02, 0xC4, 0x0B, 0x87, 0x02, 0xCF, 0x0F, 0x89, 0x02, 0xDE, 0x0A, 0x06, 0x02, 0xE8, 0x07, 0x87,
+  0x02, 0xEF, 0x09, 0x86, 0x02, 0xF8, 0x07, 0x87, 0x02, 0xFF, 0x09, 0x89, 0x03, 0x08, 0x07, 0x87,
+  0x03, 0x0F, 0x09, 0x88, 0x03, 0x18, 0x07, 0x87, 0x03, 0x1F, 0x09, 0x87, 0x03, 0x28, 0x09, 0x87,
+  0x03, 0x31, 0x06, 0x87, 0x03, 0x37, 0x08, 0x86, 0x03, 0x3F, 0x07, 0x87, 0x03, 0x46, 0x09, 0x87,
+  0x03, 0x4F, 0x09, 0x86, 0x03, 0x58, 0x08, 0x86, 0x03, 0x60, 0x06, 0x85, 0x03, 0x66, 0x04, 0x84,
+  0x03, 0x6A, 0x08, 0x86, 0x03, 0x72, 0x09, 0x86, 0x03, 0x7B, 0x09, 0x86, 0x03, 0x84, 0x08, 0x04,
+  0x03, 0x8C, 0x05, 0x86, 0x03, 0x91, 0x07, 0x86, 0x03, 0x98, 0x05, 0x85, 0x03, 0x9D, 0x06, 0x86,
+  0x03, 0xA3, 0x06, 0x87, 0x03, 0xA9, 0x05, 0x86, 0x03, 0xAE, 0x07, 0x86, 0x03, 0xB5, 0x05, 0x86,
+  0x03, 0xBA, 0x07, 0x86, 0x03, 0xC1, 0x08, 0x86, 0x03, 0xC9, 0x06, 0x85, 0x03, 0xCF, 0x06, 0x85,
+  0x03, 0xD5, 0x0B, 0x89, 0x03, 0xE0, 0x09, 0x85, 0x03, 0xE9, 0x06, 0x86, 0x03, 0xEF, 0x04, 0x85,
+  0x03, 0xF3, 0x06, 0x87, 0x03, 0xF9, 0x08, 0x87, 0x04, 0x01, 0x08, 0x87, 0x04, 0x09, 0x07, 0x86,
+  0x04, 0x10, 0x08, 0x05, 0x04, 0x18, 0x09, 0x88, 0x04, 0x21, 0x06, 0x85, 0xFD, 0xD2, 0x40, 0x8F,
+  0xFE, 0x98, 0xC4, 0xBE, 0x27, 0x24, 0x92, 0xF8, 0x9C, 0x92, 0x49, 0x60, 0x02, 0xD0, 0x04, 0xF0,
+  0x0F, 0x90, 0x04, 0x20, 0x03, 0xFE, 0x2E, 0xCA, 0x3D, 0xA4, 0xBA, 0x5D, 0x22, 0xB8, 0x28, 0xA3,
+  0xDA, 0x00, 0x03, 0xA0, 0x04, 0xD0, 0x04, 0x50, 0x05, 0x30, 0x02, 0x00, 0x07, 0x00, 0x05, 0x70,
+  0xD7, 0x83, 0x4D, 0x3C, 0x10, 0x87, 0x83, 0x4D, 0x3C, 0x50, 0x50, 0x00, 0x30, 0x00, 0x50, 0xE0,
+  0xFA, 0x7B, 0xBD, 0x9F, 0x48, 0xFF, 0xA4, 0xE4, 0xFA, 0x40, 0xFF, 0xA2, 0xE9, 0x72, 0xF9, 0x40,
+  0xB7, 0x83, 0x4E, 0x34, 0xE3, 0x4F, 0x14, 0xFE, 0x9F, 0x0F, 0x9C, 0x00, 0x20, 0x04, 0x10, 0x06,
+  0x10, 0x05, 0x90, 0x04, 0x60, 0x04, 0x20, 0x02, 0x10, 0x04, 0x90, 0x04, 0x90, 0x04, 0x60, 0x03,
+  0xE1, 0x76, 0x49, 0xE8, 0xA3, 0xC9, 0x67, 0x9E, 0x3B, 0x20, 0xC0, 0x02, 0x70, 0x04, 0x50, 0x04,
+  0x50, 0x04, 0x90, 0x03, 0xE0, 0x03, 0x50, 0x04, 0x50, 0x04, 0x50, 0x04, 0xA0, 0x03, 0x87, 0xD3,
+  0x16, 0x29, 0x72, 0xFB, 0x20, 0x60, 0x03, 0x90, 0x04, 0x90, 0x04, 0x90, 0x04, 0x60, 0x03, 0xE0,
+  0x02, 0x10, 0x05, 0x10, 0x05, 0x10, 0x05, 0xE0, 0x03, 0xFE, 0x96, 0x40, 0xFE, 0x96, 0x80, 0xFF,
+  0x1F, 0x09, 0x3D, 0x92, 0x7A, 0x2C, 0x80, 0xC4, 0x9E, 0xC9, 0x3D, 0x92, 0x7B, 0x24, 0xF6, 0x49,
+  0xFE, 0x16, 0x7A, 0x24, 0xF6, 0x49, 0xF0, 0x80, 0xA7, 0xC3, 0xE9, 0xF4, 0xA4, 0x4E, 0x28, 0xF6,
+  0x80, 0x00, 0x00, 0x80, 0x07, 0x60, 0x08, 0xA0, 0x13, 0x50, 0x14, 0x50, 0x14, 0x90, 0x17, 0xD0,
+  0x14, 0x20, 0x0A, 0xC0, 0x09, 0xEC, 0xF4, 0xF9, 0x44, 0xF2, 0x59, 0xE9, 0x13, 0xE3, 0xF8, 0x80,
+  0xFD, 0xF1, 0x8A, 0x28, 0xE2, 0x8A, 0x38, 0xA2, 0x8F, 0x14, 0xFE, 0x5E, 0x0D, 0x38, 0xD3, 0x8D,
+  0x3C, 0x16, 0x40, 0xFD, 0xF1, 0x8D, 0x38, 0xD3, 0xC1, 0x67, 0xA6, 0xFD, 0xF1, 0x8A, 0x28, 0xE2,
+  0x8A, 0x38, 0xA2, 0x8E, 0x28, 0xA2, 0xFD, 0xF1, 0x8A, 0x3D, 0x14, 0x7A, 0x20, 0xFE, 0xBE, 0x8B,
+  0x3C, 0x1A, 0x71, 0x45, 0x1E, 0x09, 0x24, 0xF6, 0x80, 0xFD, 0xF1, 0xD1, 0xF4, 0xFA, 0x7A, 0xE0,
+  0xFD, 0xF0, 0xE9, 0x7A, 0x7D, 0x3B, 0x00, 0xFD, 0xF1, 0xD9, 0xF0, 0xF8, 0x49, 0xE8, 0xB3, 0xC1,
+  0xA4, 0xFD, 0xF1, 0xE9, 0xF4, 0xFA, 0x7D, 0x20, 0xFD, 0xF1, 0xC2, 0xF9, 0xFC, 0x7A, 0x7C, 0xAE,
+  0xF8, 0xFD, 0xF1, 0xC2, 0xF8, 0xFC, 0xB8, 0xE0, 0xFE, 0x5E, 0x0D, 0x38, 0xD3, 0x8D, 0x38, 0xD3,
+  0xC5, 0xFD, 0xF1, 0x8A, 0x3D, 0x14, 0x7A, 0x28, 0xF6, 0x80, 0xFE, 0x5E, 0x0D, 0x38, 0xD3, 0x8C,
+  0x58, 0xC5, 0xC4, 0x24, 0xFD, 0xF1, 0x8A, 0x3D, 0x14, 0x7A, 0x29, 0x74, 0x92, 0x00, 0x00, 0x60,
+  0x02, 0x90, 0x04, 0x90, 0x04, 0x90, 0x04, 0x20, 0x03, 0xFD, 0x9F, 0x4F, 0xBC, 0x63, 0xE9, 0xFD,
+  0xEF, 0x8F, 0xA7, 0xD3, 0xB0, 0x87, 0xE7, 0xF2, 0xF8, 0xF6, 0xB9, 0x7D, 0x10, 0x8B, 0xE9, 0xF1,
+  0xE2, 0xF0, 0x7E, 0xBF, 0x1E, 0x67, 0x08, 0xEC, 0xE3, 0x0F, 0x25, 0x1E, 0xD7, 0x65, 0x1E, 0x4C,
+  0x3F, 0x10, 0x87, 0xE3, 0xF1, 0xFA, 0x72, 0x7C, 0x3E, 0x10, 0x10, 0x06, 0x10, 0x05, 0x90, 0x04,
+  0x50, 0x04, 0x30, 0x04, 0x10, 0x04, 0xFD, 0xF5, 0x0F, 0x04, 0x8B, 0xE7, 0xF2, 0x87, 0x83, 0x3A,
+  0xE0, 0xF6, 0xBB, 0x3F, 0x2F, 0x88, 0xF4, 0xFA, 0x7D, 0x3E, 0x9F, 0x4F, 0xA4, 0x87, 0xE2, 0xFF,
+  0x95, 0xC9, 0x24, 0x9E, 0x49, 0x24, 0xF3, 0x40, 0xFD, 0xF1, 0xC9, 0x67, 0x92, 0xCF, 0x4C, 0xFF,
+  0x3E, 0x8B, 0x3C, 0x96, 0x7A, 0x24, 0x80, 0xFF, 0x3E, 0x8B, 0x3C, 0x96, 0x77, 0x00, 0xFF, 0x3E,
+  0x89, 0x24, 0xF2, 0x49, 0x27, 0xA4, 0x48, 0xC7, 0xCD, 0x89, 0x20, 0xFF, 0x32, 0x78, 0x2C, 0x93,
+  0x8B, 0x24, 0xEC, 0xFD, 0xF1, 0xC9, 0xF4, 0xFD, 0x00, 0xFD, 0x93, 0x40, 0xF4, 0xC2, 0x70, 0x9C,
+  0x76, 0x7C, 0x7D, 0x16, 0x40, 0xFD, 0xF0, 0xFE, 0xDE, 0x4F, 0xA7, 0xDB, 0xC9, 0xF4, 0xFD, 0x00,
+  0xFE, 0xDE, 0x4F, 0xA7, 0xE8, 0xFF, 0x3E, 0x8B, 0x3C, 0x96, 0x7A, 0x60, 0xFE, 0xF1, 0x8B, 0x3C,
+  0x96, 0x7A, 0x60, 0xFF, 0x3E, 0x8B, 0x3C, 0x96, 0x79, 0xE0, 0xFE, 0xDE, 0x48, 0x80, 0x04, 0x40,
+  0x05, 0x40, 0x05, 0x40, 0x02, 0xC7, 0xBE, 0x39, 0x2C, 0x80, 0xFE, 0xCF, 0x8F, 0xA7, 0x9A, 0xC7,
+  0xE7, 0xF1, 0xE9, 0xF4, 0x40, 0xD3, 0xE3, 0xD3, 0xE8, 0xFC, 0xFE, 0x3C, 0xC0, 0xC5, 0x9E, 0x89,
+  0x3E, 0x1F, 0x09, 0x3D, 0x16, 0x40, 0xC7, 0xE6, 0x8F, 0x6B, 0x97, 0xD1, 0x40, 0x04, 0x40, 0x06,
+  0x40, 0x05, 0xC0, 0x04, 0x40, 0x04, 0xE4, 0xF3, 0x0C, 0x87, 0x82, 0xFD, 0xF4, 0x87, 0x83, 0x21,
+  0x9C, 0x90, 0xE1, 0x78, 0x7D, 0x5E, 0x9F, 0x10, 0xEC, 0xF4, 0xF9, 0x44, 0xF2, 0x59, 0xE9, 0x13,
+  0xE3, 0xF8, 0x80, 0xFD, 0xF1, 0x8A, 0x28, 0xE2, 0x8A, 0x38, 0xA2, 0x8F, 0x68, 0xFD, 0xF1, 0x8A,
+  0x28, 0xE2, 0x8A, 0x38, 0xA2, 0x8F, 0x14, 0xED, 0xF4, 0xB5, 0x27, 0x1A, 0x71, 0xA7, 0x71, 0xEB,
+  0xFD, 0xF1, 0x8A, 0x28, 0xE2, 0x8A, 0x38, 0xA2, 0x8E, 0x28, 0xA2, 0x86, 0x9C, 0x99, 0xE8, 0x93,
+  0xE1, 0xEB, 0x8E, 0x8F, 0x84, 0x9E, 0x53, 0x3C, 0x1A, 0x40, 0x20, 0x02, 0x10, 0x04, 0x90, 0x04,
+  0x90, 0x04, 0x60, 0x03, 0xFD, 0xF1, 0xDA, 0xE9, 0x76, 0x7C, 0xE0, 0xFD, 0xF1, 0xD1, 0xF0, 0x93,
+  0xD1, 0x67, 0x83, 0x48, 0xEC, 0xED, 0xC1, 0xF4, 0xFA, 0x7D, 0xE0, 0xFD, 0xF1, 0xC2, 0xF9, 0xFC,
+  0x7A, 0x7C, 0xAE, 0xF8, 0xFD, 0xF1, 0xD1, 0xF4, 0xFA, 0x7A, 0xE0, 0xFE, 0x5E, 0x0D, 0x38, 0xD3,
+  0x8D, 0x38, 0xD3, 0xC5, 0xFD, 0xF1, 0x8F, 0xA7, 0xD3, 0xEF, 0x00, 0xFD, 0xF1, 0x8A, 0x3D, 0x14,
+  0x7A, 0x28, 0xF6, 0x80, 0xFE, 0x5E, 0x0D, 0x38, 0xD3, 0x8D, 0x3C, 0x16, 0x40, 0xFD, 0x9F, 0x4F,
+  0xBC, 0x63, 0xE9, 0xFD, 0xA8, 0x79, 0x48, 0xF6, 0xBA, 0x5D, 0x20, 0xFD, 0xCF, 0x8F, 0xA7, 0xD3,
+  0xCF, 0x00, 0xFD, 0xF1, 0xD1, 0x47, 0xA2, 0x8F, 0x45, 0x1E, 0xD0, 0xFF, 0x95, 0xC9, 0x24, 0x9E,
+  0x49, 0x24, 0xF3, 0x40, 0xFE, 0x5E, 0x09, 0x2C, 0xE2, 0x4B, 0x38, 0xA6, 0xFE, 0xDE, 0x49, 0x24,
+  0xF4, 0x49, 0xFE, 0xDE, 0x4F, 0xA4, 0xFF, 0x97, 0xC3, 0x27, 0x92, 0xCF, 0x37, 0xD4, 0xFF, 0x3E,
+  0x89, 0x24, 0xF2, 0x49, 0x27, 0xA4, 0x48, 0xC5, 0x9E, 0x89, 0x3D, 0x5E, 0x89, 0x3D, 0x16, 0x40,
+  0x80, 0x02, 0x40, 0x04, 0x40, 0x05, 0x80, 0x02, 0xFE, 0xDE, 0xD7, 0x67, 0xCA, 0xFE, 0xDA, 0x9A,
+  0xE0, 0xA3, 0xCA, 0x34, 0xFE, 0xDE, 0x9F, 0x45, 0x90, 0xEC, 0xF3, 0x3A, 0x3E, 0x9F, 0x68, 0xFE,
+  0xDE, 0x5F, 0xCB, 0x97, 0xDD, 0xFE, 0xDE, 0xCF, 0xA7, 0xBA, 0xFF, 0x3E, 0x8B, 0x3C, 0x96, 0x7A,
+  0x60, 0xFE, 0xDE, 0x4F, 0xA7, 0xDA, 0xFE, 0xF1, 0x8B, 0x3C, 0x96, 0x7A, 0x60, 0xFF, 0x3E, 0x8B,
+  0x3C, 0x96, 0x7A, 0x24, 0x80, 0xC7, 0xD3, 0xED, 0xE4, 0xFA, 0x40, 0xC7, 0xE6, 0x8F, 0x6B, 0x97,
+  0xD1, 0xFF, 0x3E, 0x8B, 0x3C, 0x96, 0x77, 0x58, 0xB3, 0xC9, 0x67, 0xA6, 0xC5, 0x9E, 0x89, 0x3E,
+  0x1F, 0x09, 0x3D, 0x16, 0x40, 0xFE, 0xDF, 0x4F, 0xA7, 0x9B, 0xEB, 0xFE, 0xBF, 0x8F, 0x54, 0xFE,
+  0xDF, 0x4F, 0x37, 0xD3, 0xCD, 0xFE, 0xDF, 0x4F, 0x37, 0xD3, 0xCD, 0xF5, 0x80, 0xFE, 0xDE, 0xC9,
+  0x3D, 0x92, 0x7C, 0x3D, 0x50, 0xFE, 0xDE, 0xC9, 0x3D, 0x92, 0x7C, 0x20, 0x80, 0x02, 0x40, 0x04,
+  0x40, 0x05, 0x80, 0x03, 0xFE, 0xDE, 0xCF, 0x8F, 0xA2, 0xCF, 0x25, 0x9E, 0x98, 0xFF, 0x12, 0xB9,
+  0x24, 0xF7, 0x40,
+};
+
+const uint8_t ArialRus_Plain_24_Compact[] PROGMEM = {
+  0x1D, 0x01, 0x21, 0x01, 0x00, 0x00, 0x00, 0x09, 0x88, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xFE, 0x4B,
+  0xDF, 0x92,
+};
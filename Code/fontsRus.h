@@ -3,8 +3,15 @@
 #ifndef FONTSRUS_h
 #define FONTSRUS_h
 
+// Декодирование UTF-8 во время отрисовки - только для строк пользователя (SSID).
+// Статический текст перекодируется при компиляции (Cp1251.h).
+// Состояние своё у каждой задачи; оборванная последовательность не портит следующую строку.
 inline char FontUtf8Rus(const byte ch) {
-    static uint8_t LASTCHAR;
+    static thread_local uint8_t LASTCHAR;
+    if (ch < 0x80) {
+        LASTCHAR = 0;
+        return ch;
+    }
     if ((LASTCHAR == 0) && (ch < 0xC0)) {
         return ch;
     }
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+# Сборка компактных шрифтов для OLED из Code/fontsRus.h.
+#
+# Прошивка рисует только литералы CP1251("...") и строки пользователя
+# (SSID, пароль точки доступа, IP, числа). Скрипт собирает символы из всех
+# CP1251("...") в Code/, добавляет печатные ASCII и оставляет в шрифте
+# только эти глифы. Битмапы глифов сжимаются битовым RLE, если это их
+# уменьшает (декодер - Code/CompactFont.h). Карта символов хранит только диапазон
+# от первого до последнего использованного кода.
+# Результат - Code/fontsCompact.h с отчетом о размере по каждому шрифту.
+#
+# Запуск из корня репозитория после изменения надписей на экране:
+#   python3 tools/fontsubset.py
+
+import glob
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+CODE = os.path.join(ROOT, "Code")
+SOURCE = os.path.join(CODE, "fontsRus.h")
+OUTPUT = os.path.join(CODE, "fontsCompact.h")
+
+# (шрифт в fontsRus.h, набор символов; None - надписи прошивки + ASCII)
+FONTS = [
+    ("ArialRus_Plain_10", None),
+    ("ArialRus_Plain_24", "!"),   # Знак на экране сброса
+]
+
+MAX_GLYPH_BYTES = 128   # Буфер декодирования в CompactFont.h
+NO_GLYPH = 0xFF
+RLE_FLAG = 0x80         # В байте ширины: данные глифа сжаты
+
+
+def load_font(text, name):
+    match = re.search(r"const uint8_t " + name + r"\[\] PROGMEM = \{(.*?)\};", text, re.S)
+    if not match:
+        sys.exit("font %s not found in fontsRus.h" % name)
+    body = re.sub(r"//[^\n]*", "", match.group(1))
+    data = [int(token, 16) for token in re.findall(r"0x[0-9A-Fa-f]{1,2}", body)]
+    height, first, count = data[1], data[2], data[3]
+    table = data[4:4 + count * 4]
+    glyph_data = data[4 + count * 4:]
+    glyphs = {}
+    for i in range(count):
+        msb, lsb, size, width = table[i * 4:i * 4 + 4]
+        offset = (msb << 8) | lsb
+        raw = [] if offset == 0xFFFF else glyph_data[offset:offset + size]
+        glyphs[first + i] = (width, raw)
+    return height, glyphs, len(data)
+
+
+def used_characters():
+    chars = set(range(0x20, 0x7F))
+    pattern = re.compile(r'CP1251\("((?:[^"\\]|\\.)*)"\)')
+    for path in glob.glob(os.path.join(CODE, "*.h")) + glob.glob(os.path.join(CODE, "*.ino")):
+        with open(path, encoding="utf-8") as source:
+            for literal in pattern.findall(source.read()):
+                for byte in literal.encode("cp1251"):
+                    chars.add(byte)
+    return chars
+
+
+# Битовый RLE по растру глифа. Пиксели идут по столбцам сверху вниз, height бит
+# на столбец, без добивки до байта. Серии одного цвета чередуются, первая серия -
+# фон (может быть пустой). Длина серии - группы по RUN_BITS бит, старшим битом
+# вперед: RUN_CONTINUE - "+RUN_CONTINUE, дальше следующая группа", иначе последняя
+# группа. Хвост фона не кодируется: недописанные пиксели - нули.
+# Байтовый RLE 10-пиксельному шрифту не помогал (в столбце 2 байта, повторов
+# почти нет), а серии пикселей короткие - 3 бит на группу хватает.
+RUN_BITS = 3
+RUN_CONTINUE = (1 << RUN_BITS) - 1
+
+
+def glyph_pixels(width, height, raw):
+    raster = 1 + ((height - 1) >> 3)
+    raw = (raw + [0] * (width * raster))[:width * raster]
+    pixels = []
+    for x in range(width):
+        for y in range(height):
+            pixels.append((raw[x * raster + (y >> 3)] >> (y & 7)) & 1)
+    return pixels
+
+
+def rle_encode(width, height, raw):
+    pixels = glyph_pixels(width, height, raw)
+    while pixels and pixels[-1] == 0:
+        pixels.pop()
+    runs = []
+    color, length = 0, 0
+    for pixel in pixels:
+        if pixel != color:
+            runs.append(length)
+            color, length = pixel, 0
+        length += 1
+    if pixels:
+        runs.append(length)
+    groups = []
+    for length in runs:
+        while length >= RUN_CONTINUE:
+            groups.append(RUN_CONTINUE)
+            length -= RUN_CONTINUE
+        groups.append(length)
+    bits = []
+    for group in groups:
+        bits += [(group >> shift) & 1 for shift in range(RUN_BITS - 1, -1, -1)]
+    bits += [0] * (-len(bits) % 8)
+    return [int("".join(map(str, bits[i:i + 8])), 2) for i in range(0, len(bits), 8)]
+
+
+# Повторяет CompactFont::decodeGlyph
+def rle_decode(encoded, width, height, size):
+    out = [0] * size
+    total = width * height
+    position, color, length = 0, 0, 0
+    for i in range(len(encoded) * 8 // RUN_BITS):
+        group = 0
+        for bit in range(i * RUN_BITS, (i + 1) * RUN_BITS):
+            group = (group << 1) | ((encoded[bit >> 3] >> (7 - (bit & 7))) & 1)
+        length += group
+        if group == RUN_CONTINUE:
+            continue
+        for _ in range(length):
+            if position >= total:
+                break
+            if color:
+                index = (position // height) * (1 + ((height - 1) >> 3)) + (position % height >> 3)
+                if index < size:
+                    out[index] |= 1 << (position % height & 7)
+            position += 1
+        color ^= 1
+        length = 0
+    return out
+
+
+def build(name, height, glyphs, charset):
+    raster = 1 + ((height - 1) >> 3)
+    codes = sorted(code for code in charset if code in glyphs)
+    if len(codes) >= NO_GLYPH:
+        sys.exit("%s: too many glyphs" % name)
+    first, last = codes[0], codes[-1]
+    glyph_map = [NO_GLYPH] * (last - first + 1)
+    table = []
+    data = []
+    compressed = 0
+    for index, code in enumerate(codes):
+        width, raw = glyphs[code]
+        size = width * raster
+        if size > MAX_GLYPH_BYTES or width >= RLE_FLAG:
+            sys.exit("%s: glyph %d is larger than MAX_GLYPH_BYTES" % (name, code))
+        encoded = rle_encode(width, height, raw)
+        assert rle_decode(encoded, width, height, size) == (raw + [0] * size)[:size]
+        flags = 0
+        if len(encoded) < len(raw):
+            stored, flags = encoded, RLE_FLAG
+            compressed += 1
+        else:
+            stored = raw
+        if len(stored) > 255 or len(data) > 0xFFFF:
+            sys.exit("%s: glyph %d does not fit the table" % (name, code))
+        glyph_map[code - first] = index
+        table += [len(data) >> 8, len(data) & 0xFF, len(stored), width | flags]
+        data += stored
+    header = [height, len(codes), first, len(glyph_map)]
+    return header + glyph_map + table + data, len(codes), compressed
+
+
+def format_array(name, blob):
+    lines = ["const uint8_t %s_Compact[] PROGMEM = {" % name]
+    for i in range(0, len(blob), 16):
+        lines.append("  " + ", ".join("0x%02X" % byte for byte in blob[i:i + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main():
+    with open(SOURCE, encoding="utf-8") as source:
+        text = source.read()
+    labels = used_characters()
+
+    report = []
+    arrays = []
+    for name, chars in FONTS:
+        height, glyphs, original = load_font(text, name)
+        charset = labels if chars is None else set(chars.encode("cp1251"))
+        blob, count, compressed = build(name, height, glyphs, charset)
+        saved = 100 - 100 * len(blob) // original
+        report.append("%s: %d -> %d glyphs (%d RLE), %d -> %d bytes (-%d%%)"
+                      % (name, len(glyphs), count, compressed, original, len(blob), saved))
+        arrays.append(format_array(name, blob))
+
+    with open(OUTPUT, "w", encoding="utf-8") as out:
+        out.write("#pragma once\n#include <Arduino.h>\n\n")
+        out.write("// Сгенерировано tools/fontsubset.py из fontsRus.h - не редактировать вручную.\n")
+        out.write("// Формат описан в CompactFont.h.\n//\n")
+        for line in report:
+            out.write("// " + line + "\n")
+        out.write("\n" + "\n\n".join(arrays) + "\n")
+
+    for line in report:
+        print(line)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,55 @@
+#pragma once
+// Минимальная замена Arduino.h для сборки модулей прошивки на ПК
+// (tools/httpbench.cpp). Только то, что нужно этим модулям. tools/tempbench.cpp
+// собирается без нее: Code/Temperature.h зависит только от стандартной библиотеки.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <chrono>
+#include <string>
+#include <thread>
+
+inline unsigned long millis() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+inline unsigned long micros() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+inline void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// Подмножество Arduino String поверх std::string
+class String {
+public:
+  String() {}
+  String(const char* text) : value(text ? text : "") {}
+  String(char c) : value(1, c) {}
+  String(int number) : value(std::to_string(number)) {}
+  String(unsigned int number) : value(std::to_string(number)) {}
+  String(long number) : value(std::to_string(number)) {}
+  String(unsigned long number) : value(std::to_string(number)) {}
+
+  const char* c_str() const { return value.c_str(); }
+  unsigned int length() const { return value.size(); }
+  bool reserve(unsigned int size) { value.reserve(size); return true; }
+
+  String& operator+=(const String& other) { value += other.value; return *this; }
+  String& operator+=(const char* other) { value += other; return *this; }
+  String& operator+=(char other) { value += other; return *this; }
+  bool operator==(const char* other) const { return value == other; }
+
+  friend String operator+(String left, const String& right) { left += right; return left; }
+  friend String operator+(String left, const char* right) { left += right; return left; }
+
+private:
+  std::string value;
+};
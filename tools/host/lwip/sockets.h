@@ -0,0 +1,28 @@
+#pragma once
+// lwip_* поверх сокетов POSIX для сборки HttpServer на ПК
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+inline int lwip_socket(int domain, int type, int protocol) { return ::socket(domain, type, protocol); }
+inline int lwip_setsockopt(int fd, int level, int name, const void* value, socklen_t length) {
+  return ::setsockopt(fd, level, name, value, length);
+}
+inline int lwip_bind(int fd, const sockaddr* address, socklen_t length) { return ::bind(fd, address, length); }
+inline int lwip_listen(int fd, int backlog) { return ::listen(fd, backlog); }
+inline int lwip_accept(int fd, sockaddr* address, socklen_t* length) { return ::accept(fd, address, length); }
+inline int lwip_close(int fd) { return ::close(fd); }
+inline int lwip_fcntl(int fd, int command, int value) { return ::fcntl(fd, command, value); }
+inline int lwip_select(int count, fd_set* readable, fd_set* writable, fd_set* failed, timeval* timeout) {
+  return ::select(count, readable, writable, failed, timeout);
+}
+inline ssize_t lwip_recv(int fd, void* buffer, size_t size, int flags) { return ::recv(fd, buffer, size, flags); }
+// MSG_NOSIGNAL: закрытый клиентом сокет не должен убивать процесс SIGPIPE
+inline ssize_t lwip_send(int fd, const void* buffer, size_t size, int flags) {
+  return ::send(fd, buffer, size, flags | MSG_NOSIGNAL);
+}
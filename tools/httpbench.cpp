@@ -0,0 +1,54 @@
+// HttpServer (Code/HttpServer.h) на ПК для нагрузочного теста tools/loadtest.py.
+// Сокеты lwIP заменены POSIX (tools/host/lwip/sockets.h), Arduino.h и String -
+// минимальные заглушки (tools/host/Arduino.h). Код сервера тот же, что в прошивке.
+//
+// Маршруты повторяют веб-интерфейс по характеру ответа:
+//   GET  /          - короткий ответ
+//   POST /schedule  - разбор формы, ответ с аргументами
+//   GET  /history   - chunked-ответ на ~20 КБ
+//
+// Сборка и запуск из корня репозитория:
+//   g++ -std=gnu++11 -O2 -Itools/host -ICode tools/httpbench.cpp -o /tmp/httpbench
+//   /tmp/httpbench 8089
+
+#include <Arduino.h>
+#include <signal.h>
+#include "HttpServer.h"
+
+int main(int argc, char** argv) {
+  signal(SIGPIPE, SIG_IGN);
+  uint16_t port = argc > 1 ? atoi(argv[1]) : 8089;
+  HttpServer server(port);
+
+  server.on("/", [&]() {
+    server.send(200, "text/plain", "ok");
+  });
+  server.on("/schedule", HttpServer::Method::POST, [&]() {
+    server.send(200, "text/plain", server.arg("d0") + "|" + server.arg("d1"));
+  });
+  server.on("/history", HttpServer::Method::GET, [&]() {
+    unsigned line = 0;
+    server.sendChunked(200, "text/csv", [line](char* out, size_t size) mutable -> size_t {
+      if(line >= 400) return 0;
+      line++;
+      return snprintf(out, size, "%u,23.50,24.00,23.75,50,0\n", 1700000000u + line * 60);
+    });
+  });
+
+  server.begin();
+  printf("httpbench: port %u\n", (unsigned)port);
+  fflush(stdout);
+  unsigned long lastReport = millis();
+  for(;;) {
+    server.waitForEvents(1000);
+    server.poll();
+    if(millis() - lastReport >= 5000) {
+      lastReport = millis();
+      const HttpServer::Stats& stats = server.getStats();
+      printf("web: accepted=%u requests=%u reused=%u timeouts=%u errors=%u max_handler_us=%u\n",
+             (unsigned)stats.accepted, (unsigned)stats.requests, (unsigned)stats.reused,
+             (unsigned)stats.timeouts, (unsigned)stats.errors, (unsigned)stats.maxHandlerUs);
+      fflush(stdout);
+    }
+  }
+}
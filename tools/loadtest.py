@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+# Нагрузочный тест веб-сервера (Code/HttpServer.h).
+#
+# Открывает --connections keep-alive соединений и гоняет по каждому запросы
+# подряд (следующий - после ответа на предыдущий) в течение --duration секунд.
+# Дополнительно --stalled соединений присылают половину заголовка и молчат:
+# сервер не должен из-за них задерживать остальных.
+# Итог: запросов в секунду и задержка ответа p50/p95/p99/max.
+#
+# Против прошивки:
+#   python3 tools/loadtest.py --host 192.168.4.1 --port 80 --path /
+# Против сборки на ПК (tools/httpbench.cpp):
+#   /tmp/httpbench 8089 &
+#   python3 tools/loadtest.py --port 8089 --connections 3 --stalled 1
+#
+# Слотов у сервера MAX_CONNECTIONS (4): connections + stalled не должно быть больше.
+
+import argparse
+import asyncio
+import sys
+import time
+
+POST_BODY = b"d0=08%3A00-12%3A00&d1=13%3A00-18%3A00"
+
+
+def build_request(path, host):
+    if path == "/schedule":
+        return (b"POST /schedule HTTP/1.1\r\nHost: " + host.encode() +
+                b"\r\nContent-Type: application/x-www-form-urlencoded\r\nContent-Length: " +
+                str(len(POST_BODY)).encode() + b"\r\n\r\n" + POST_BODY)
+    return b"GET " + path.encode() + b" HTTP/1.1\r\nHost: " + host.encode() + b"\r\n\r\n"
+
+
+async def read_response(reader):
+    head = await reader.readuntil(b"\r\n\r\n")
+    status = int(head.split(b" ", 2)[1])
+    headers = {}
+    for line in head.split(b"\r\n")[1:]:
+        if b":" in line:
+            name, value = line.split(b":", 1)
+            headers[name.strip().lower()] = value.strip().lower()
+    if headers.get(b"transfer-encoding") == b"chunked":
+        while True:
+            size = int((await reader.readuntil(b"\r\n")).strip(), 16)
+            await reader.readexactly(size + 2)
+            if size == 0:
+                break
+    else:
+        await reader.readexactly(int(headers.get(b"content-length", b"0")))
+    return status, headers.get(b"connection") != b"close"
+
+
+async def client(args, paths, deadline, latencies, errors):
+    reader, writer = await asyncio.open_connection(args.host, args.port)
+    requests = [build_request(path, args.host) for path in paths]
+    index = 0
+    try:
+        while time.perf_counter() < deadline:
+            start = time.perf_counter()
+            writer.write(requests[index % len(requests)])
+            index += 1
+            status, keep_alive = await read_response(reader)
+            latencies.append(time.perf_counter() - start)
+            if status != 200:
+                errors.append(status)
+            if not keep_alive:
+                writer.close()
+                reader, writer = await asyncio.open_connection(args.host, args.port)
+    finally:
+        writer.close()
+
+
+async def stalled(args, deadline):
+    reader, writer = await asyncio.open_connection(args.host, args.port)
+    writer.write(b"GET / HTTP/1.1\r\nHost: ")
+    await writer.drain()
+    # Сервер закроет соединение по IDLE_TIMEOUT - тогда открыть заново
+    while time.perf_counter() < deadline:
+        try:
+            data = await asyncio.wait_for(reader.read(1), deadline - time.perf_counter())
+        except asyncio.TimeoutError:
+            break
+        if not data:
+            writer.close()
+            reader, writer = await asyncio.open_connection(args.host, args.port)
+            writer.write(b"GET / HTTP/1.1\r\nHost: ")
+            await writer.drain()
+    writer.close()
+
+
+def percentile(sorted_values, fraction):
+    index = min(len(sorted_values) - 1, int(round(fraction * (len(sorted_values) - 1))))
+    return sorted_values[index]
+
+
+async def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8089)
+    parser.add_argument("--connections", type=int, default=3)
+    parser.add_argument("--stalled", type=int, default=0)
+    parser.add_argument("--duration", type=float, default=10.0)
+    parser.add_argument("--path", action="append",
+                        help="маршрут (можно несколько, чередуются); по умолчанию /")
+    args = parser.parse_args()
+    paths = args.path or ["/"]
+
+    latencies = []
+    errors = []
+    deadline = time.perf_counter() + args.duration
+    tasks = [stalled(args, deadline) for _ in range(args.stalled)]
+    await asyncio.sleep(0)
+    started = time.perf_counter()
+    tasks += [client(args, paths, deadline, latencies, errors) for _ in range(args.connections)]
+    await asyncio.gather(*tasks)
+    elapsed = time.perf_counter() - started
+
+    if not latencies:
+        print("no responses")
+        return 1
+    latencies.sort()
+    ms = lambda value: value * 1000
+    print("paths=%s connections=%d stalled=%d duration=%.1fs" %
+          (",".join(paths), args.connections, args.stalled, elapsed))
+    print("requests=%d errors=%d rate=%.0f req/s" %
+          (len(latencies), len(errors), len(latencies) / elapsed))
+    print("latency_ms p50=%.3f p95=%.3f p99=%.3f max=%.3f" %
+          (ms(percentile(latencies, 0.50)), ms(percentile(latencies, 0.95)),
+           ms(percentile(latencies, 0.99)), ms(latencies[-1])))
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(asyncio.run(main()))
@@ -0,0 +1,150 @@
+// Сравнение float и TempCenti (Code/Temperature.h) на ПК:
+//  - перевод сырого значения DS18B20 (1/128 °C) в градусы;
+//  - форматирование для экрана и CSV ("23.5");
+//  - проверка порога с калибровкой.
+// Абсолютные числа на ПК не равны ESP32, смысл - соотношение вариантов.
+// Вход один и тот же, контрольные суммы не дают компилятору выбросить работу.
+// У форматирования сумма - FNV-1a всего текста по порядку выборок; совпадение
+// текста побайтно проверяет отдельный проход в конце.
+//
+// Сборка и запуск из корня репозитория:
+//   g++ -std=gnu++11 -O2 -ICode tools/tempbench.cpp -o /tmp/tempbench && /tmp/tempbench
+
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "Temperature.h"
+
+static const size_t SAMPLES = 4096;
+static const int ROUNDS = 500;
+
+struct Result {
+  double nsPerOp;
+  uint32_t checksum;
+};
+
+template<typename Body>
+static Result measure(Body body) {
+  uint32_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for(int round = 0; round < ROUNDS; round++) {
+    checksum += body();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+  return {ns / ((double)ROUNDS * SAMPLES), checksum};
+}
+
+static const uint32_t FNV_BASIS = 2166136261u;
+
+// FNV-1a, продолжающий hash: текст целиком и порядок выборок, а не только
+// длина и первый символ
+static uint32_t hashText(const char* text, uint32_t hash) {
+  while(*text) hash = (hash ^ (uint8_t)*text++) * 16777619u;
+  return hash * 16777619u; // Граница строки (байт 0): "1","23" != "12","3"
+}
+
+// Побайтное сравнение "%.Nf" и formatTemp(N) на всех выборках
+static void compareText(const std::vector<float>& celsius, const std::vector<TempCenti>& centi,
+                        uint8_t decimals) {
+  char format[8];
+  snprintf(format, sizeof(format), "%%.%uf", (unsigned)decimals);
+  char expected[16];
+  char text[16];
+  uint32_t mismatches = 0;
+  size_t first = SAMPLES;
+  for(size_t i = 0; i < SAMPLES; i++) {
+    snprintf(expected, sizeof(expected), format, celsius[i]);
+    formatTemp(text, sizeof(text), centi[i], decimals);
+    if(strcmp(expected, text) != 0) {
+      if(mismatches == 0) first = i;
+      mismatches++;
+    }
+  }
+  printf("\"%s\" vs formatTemp(%u): %u of %u differ", format, (unsigned)decimals,
+         (unsigned)mismatches, (unsigned)SAMPLES);
+  if(mismatches > 0) {
+    snprintf(expected, sizeof(expected), format, celsius[first]);
+    formatTemp(text, sizeof(text), centi[first], decimals);
+    printf(" (rounding, e.g. %.4f: \"%s\" vs \"%s\")", celsius[first], expected, text);
+  }
+  printf("\n");
+}
+
+static void report(const char* name, const Result& result) {
+  printf("%-28s %8.2f ns/op  (checksum %08x)\n", name, result.nsPerOp, (unsigned)result.checksum);
+}
+
+int main() {
+  // -10..+110 °C с шагом 1/16 - как отдает DS18B20 при 12 битах, в 1/128
+  std::vector<int32_t> raw(SAMPLES);
+  for(size_t i = 0; i < SAMPLES; i++) {
+    raw[i] = (-160 + (int32_t)((i * 37) % 1920)) * 8;
+  }
+  std::vector<float> celsius(SAMPLES);
+  std::vector<TempCenti> centi(SAMPLES);
+  for(size_t i = 0; i < SAMPLES; i++) {
+    celsius[i] = raw[i] / 128.0f;
+    centi[i] = centiFromRaw(raw[i]);
+  }
+  char text[16];
+
+  printf("samples=%u rounds=%u\n", (unsigned)SAMPLES, (unsigned)ROUNDS);
+
+  report("raw -> float", measure([&]() {
+    float sum = 0;
+    for(size_t i = 0; i < SAMPLES; i++) sum += raw[i] * 0.0078125f;
+    return (uint32_t)lroundf(sum);
+  }));
+  report("raw -> TempCenti", measure([&]() {
+    int32_t sum = 0;
+    for(size_t i = 0; i < SAMPLES; i++) sum += centiFromRaw(raw[i]);
+    return (uint32_t)sum;
+  }));
+
+  report("snprintf(\"%.1f\", float)", measure([&]() {
+    uint32_t hash = FNV_BASIS;
+    for(size_t i = 0; i < SAMPLES; i++) { snprintf(text, sizeof(text), "%.1f", celsius[i]); hash = hashText(text, hash); }
+    return hash;
+  }));
+  report("formatTemp(TempCenti, 1)", measure([&]() {
+    uint32_t hash = FNV_BASIS;
+    for(size_t i = 0; i < SAMPLES; i++) { formatTemp(text, sizeof(text), centi[i], 1); hash = hashText(text, hash); }
+    return hash;
+  }));
+  report("snprintf(\"%.2f\", float)", measure([&]() {
+    uint32_t hash = FNV_BASIS;
+    for(size_t i = 0; i < SAMPLES; i++) { snprintf(text, sizeof(text), "%.2f", celsius[i]); hash = hashText(text, hash); }
+    return hash;
+  }));
+  report("formatTemp(TempCenti, 2)", measure([&]() {
+    uint32_t hash = FNV_BASIS;
+    for(size_t i = 0; i < SAMPLES; i++) { formatTemp(text, sizeof(text), centi[i], 2); hash = hashText(text, hash); }
+    return hash;
+  }));
+
+  const float offsetFloat = -0.25f;
+  const float thresholdFloat = 75.0f;
+  const TempCenti offsetCenti = -degreesC(0, 25);
+  const TempCenti thresholdCenti = degreesC(75);
+  report("float + offset >= 75.0", measure([&]() {
+    uint32_t hits = 0;
+    for(size_t i = 0; i < SAMPLES; i++) hits += (celsius[i] + offsetFloat >= thresholdFloat);
+    return hits;
+  }));
+  report("centi + offset >= 7500", measure([&]() {
+    uint32_t hits = 0;
+    for(size_t i = 0; i < SAMPLES; i++) hits += (centi[i] + offsetCenti >= thresholdCenti);
+    return hits;
+  }));
+
+  // Совпадает ли текст: printf округляет точное двоичное значение float (ровные
+  // половины - к четному), TempCenti - уже округленные сотые (от нуля), так что на
+  // шаге 1/16 °C возможны расхождения в последнем знаке
+  compareText(celsius, centi, 1);
+  compareText(celsius, centi, 2);
+  return 0;
+}